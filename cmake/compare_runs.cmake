@@ -0,0 +1,27 @@
+# Simulate CIR twice in parallel and once serially, the three outputs have to
+# be identical. Called by add_integration_test with COMPARE_PARALLEL.
+
+foreach(RUN parallel_1 parallel_2 serial)
+  if(RUN STREQUAL "serial")
+    set(ARGS "-m" "1")
+  else()
+    set(ARGS "-p" "-m" "1")
+  endif()
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -E env OMP_NUM_THREADS=4
+            ${JOSIM} ${ARGS} -o "${RUN}.csv" "${CIR}"
+    RESULT_VARIABLE RESULT
+    OUTPUT_QUIET)
+  if(NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "The ${RUN} run of ${CIR} failed")
+  endif()
+endforeach()
+
+foreach(RUN parallel_2 serial)
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files parallel_1.csv "${RUN}.csv"
+    RESULT_VARIABLE RESULT)
+  if(NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "The ${RUN} run of ${CIR} differs from the first parallel run")
+  endif()
+endforeach()
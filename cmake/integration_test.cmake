@@ -1,5 +1,5 @@
 function(add_integration_test)
-  set(option_args WILL_FAIL)
+  set(option_args WILL_FAIL COMPARE_PARALLEL)
   set(single_args NAME CIR OUT)
   set(multi_args OVERWRITE_ARGS)
   cmake_parse_arguments(TEST
@@ -27,8 +27,11 @@ function(add_integration_test)
 
   if(DEFINED TEST_OVERWRITE_ARGS)
     set(JOSIM_COMMAND JoSIM ${TEST_OVERWRITE_ARGS})
-  else()
-
+  elseif(TEST_COMPARE_PARALLEL)
+    set(JOSIM_COMMAND ${CMAKE_COMMAND}
+                      "-DJOSIM=$<TARGET_FILE:josim-cli>"
+                      "-DCIR=${TEST_BUILD_DIR}/${TEST_CIR}"
+                      -P "${PROJECT_SOURCE_DIR}/cmake/compare_runs.cmake")
   endif()
 
   add_test(NAME "integration::${TEST_NAME}"
@@ -0,0 +1,51 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_BATCH_HPP
+#define JOSIM_BATCH_HPP
+
+#include "JoSIM/Input.hpp"
+#include "JoSIM/Output.hpp"
+#include "JoSIM/ParameterName.hpp"
+#include "JoSIM/Simulation.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace JoSIM {
+
+/*
+  Many simulations of one parsed and expanded netlist, for the Monte Carlo,
+  margin and sweep analyses.
+*/
+
+class Batch {
+  public:
+    // Worker threads for count tasks, from the THREADS option or the hardware
+    static int64_t threads(const Input& iObj, int64_t count);
+
+    // Run task(k) for k = 0..count-1 on the given number of threads. Tasks are
+    // started in order, the first failure stops the others from starting and
+    // is rethrown once all threads are done.
+    static void    run(int64_t                             count,
+                       int64_t                             threads,
+                       const std::function<void(int64_t)>& task,
+                       const std::string&                  status,
+                       bool                                argMin);
+
+    // Give parameters new expressions and evaluate all parameters and models again
+    static void    assign(Input& iObj, const std::vector<std::pair<ParameterName, std::string>>& expressions);
+
+    // Simulate a copy of the input without terminal output, drawing spread and
+    // noise from the streams of run index. Returns the output traces.
+    static Output  simulate(const Input&          iObj,
+                            uint64_t              index,
+                            bool                  sanityCheck = false,
+                            const SharedSymbolic* symbolic    = nullptr);
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_BATCH_HPP
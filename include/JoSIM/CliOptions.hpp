@@ -18,6 +18,7 @@ struct CliOptions {
   private:
     tokens_t                        argv_to_tokens(const int64_t& argc, const char** argv);
     vector_pair_t<char_o, string_o> argument_pairs(const tokens_t& tokens);
+    static bool                     no_value(char flag);
 
   public:
     string_o                        cir_file_name;
@@ -27,6 +28,8 @@ struct CliOptions {
 
     int64_t                         verbose       = 0;
     bool                            minimal       = false;
+    // Write raw output files in binary
+    bool                            binary        = false;
     bool                            parallel      = false;
     bool                            sanityCheck   = false;
     std::unordered_set<std::string> sanityCheckSubckts;
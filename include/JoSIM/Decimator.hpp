@@ -0,0 +1,109 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_DECIMATOR_HPP
+#define JOSIM_DECIMATOR_HPP
+
+#include "JoSIM/Input.hpp"
+#include "JoSIM/Matrix.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace JoSIM {
+
+// Receives the print time and the filtered traces of every print step as soon as it is filtered
+using PrintSink = std::function<void(double, const std::vector<double>&)>;
+
+/*
+  Traces filtered at the print times while simulating.
+
+  The output filters the steps of every trace with a Hanning window
+  centered on each print time, discarding the other steps. The decimator
+  does the same as the steps arrive: every trace keeps its values of the
+  last window of steps, converting phases to voltages or back as it goes,
+  and a print time is filtered once the half window after it has been
+  simulated. Memory is bounded by the window instead of the length of the
+  transient, and the values are the same as those filtered from the stored
+  steps.
+*/
+
+class Decimator {
+  private:
+    // How the value of a trace at a step is derived from the solution
+    enum class Kind {
+        // Difference of two variables
+        Difference,
+        // A single variable
+        Variable,
+        // Voltage from the difference of two phases
+        Derivative,
+        // Phase integrated from the difference of two voltages
+        Integral,
+        // Value of a source function
+        Source
+    };
+
+    struct Channel {
+        Kind                kind;
+        int64_t             index1 = -1, index2 = -1, source = -1;
+        // Differences at the previous two steps, or the phase integrated up to them
+        double              previous1 = 0.0, previous2 = 0.0;
+        // Value at the first step, and at the last window of steps by step modulo the window size
+        double              first     = 0.0;
+        std::vector<double> recent;
+        std::vector<double> data;
+    };
+
+    struct Print {
+        int64_t step;
+        double  time;
+    };
+
+    bool                 enabled_ = false;
+    std::vector<Channel> channels_;
+    std::vector<double>  window_;
+    int64_t              half_    = 0;
+    double               prstart_ = 0.0, prstep_ = 0.0, tstep_ = 0.0;
+    // Steps seen, the time of the first one and the next print time, and the print steps waiting for the steps
+    // after them
+    int64_t              count_   = 0;
+    double               start_   = 0.0, next_ = 0.0;
+    bool                 started_ = false;
+    std::deque<Print>    pending_;
+    std::vector<double>  times_;
+    // Filtered traces of the last print step, handed to the sink instead of stored if there is one
+    std::vector<double>  row_;
+    PrintSink            sink_;
+
+    double               sample(Channel& c, Matrix& mObj, double t, const std::vector<double>& x) const;
+    // Filter print step center at time t with the steps seen so far, the last one standing in for those after it
+    void                 filter(int64_t center, double t);
+
+  public:
+    // Hanning taps of the print filter of the transient, a single tap if it is disabled
+    static std::vector<double> window(const Transient& tran);
+
+    // Set up the traces of input iObj stored for matrix mObj. Current source traces of noise sources are not
+    // filtered while simulating, as evaluating them draws noise.
+    void                       load(const Input& iObj, const Matrix& mObj);
+
+    bool                       enabled() const { return enabled_; }
+
+    // Hand the print steps to sink instead of storing them, until cleared
+    void                       sink(PrintSink sink) { sink_ = std::move(sink); }
+
+    // Add the solution x of the step at time t
+    void                       push(Matrix& mObj, double t, const std::vector<double>& x);
+
+    // Filter the remaining print steps and move the print times and the traces, in the order of the relevant
+    // traces or of the nodes if there are none, out of the decimator. Both are empty with a sink.
+    void                       finish(std::vector<double>& times, std::vector<std::vector<double>>& traces);
+
+    void                       clear();
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_DECIMATOR_HPP
@@ -101,7 +101,17 @@ enum class ControlErrors : int64_t {
     INVALID_FILE_COMMAND,
     INVALID_IV_COMMAND,
     IV_MODEL_NOT_FOUND,
-    NODECURRENT
+    NODECURRENT,
+    ADAPTIVE_WITH_TX,
+    ENSEMBLE_FIXED_STEP,
+    ANALYSIS_PARAM_NOT_FOUND,
+    MARGIN_NO_PHASE,
+    INVALID_PASS,
+    PASS_TRACE_NOT_FOUND,
+    INVALID_SWEEP,
+    PARAREAL_UNSUPPORTED,
+    PSS_UNSUPPORTED,
+    PSS_NOT_CONVERGED
 };
 
 enum class ModelErrors : int64_t { PARAM_TYPE_ERROR, PARAM_PARENTHESIS, UNKNOWN_MODEL_TYPE, BAD_MODEL_DEFINITION };
@@ -153,7 +163,7 @@ enum class ParsingErrors : int64_t {
     INVALID_DECLARATION
 };
 
-enum class OutputErrors : int64_t { CANNOT_OPEN_FILE, NOTHING_SPECIFIED };
+enum class OutputErrors : int64_t { CANNOT_OPEN_FILE, NOTHING_SPECIFIED, CANNOT_READ_STORE, INVALID_STORE };
 
 enum class NetlistErrors : int64_t { NO_SUCH_NODE, MISSING_IO };
 
@@ -0,0 +1,57 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef SLU
+#    ifndef JOSIM_FACTORCACHE_HPP
+#        define JOSIM_FACTORCACHE_HPP
+
+#        include <suitesparse/klu.h>
+
+#        include <cstdint>
+#        include <list>
+#        include <string>
+#        include <unordered_map>
+
+namespace JoSIM {
+
+/*
+  Least recently used cache of KLU numeric factorizations.
+
+  Entries are keyed by the junction state signature of the matrix they
+  factorize. The cache owns every factorization inserted into it and frees the
+  least recently used ones once the total memory exceeds the given cap.
+*/
+
+class FactorCache {
+  private:
+    struct Entry {
+        std::string    key;
+        klu_l_numeric* numeric;
+        size_t         bytes;
+    };
+
+    size_t                                                        capacity_ = 0;
+    size_t                                                        bytes_    = 0;
+    std::list<Entry>                                              entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> lookup_;
+
+  public:
+    void           capacity(size_t bytes) { capacity_ = bytes; }
+
+    size_t         capacity() const { return capacity_; }
+
+    size_t         bytes() const { return bytes_; }
+
+    // Return the factorization for this signature, or nullptr if not cached
+    klu_l_numeric* find(const std::string& key);
+
+    // Take ownership of a new factorization, evicting old ones beyond capacity
+    void           insert(const std::string& key, klu_l_numeric* numeric, size_t bytes, klu_l_common* common);
+
+    // Free all cached factorizations
+    void           clear(klu_l_common* common);
+};
+
+} // namespace JoSIM
+
+#    endif // JOSIM_FACTORCACHE_HPP
+#endif     // SLU
@@ -10,7 +10,8 @@
 
 namespace JoSIM {
 
-enum class FileOutputType { Csv = 0, Dat = 1, Raw = 2 };
+// Binary is a raw file with the values as little endian doubles, Store is a native columnar trace store
+enum class FileOutputType { Csv = 0, Dat = 1, Raw = 2, Binary = 3, Store = 4 };
 
 class OutputFile {
   private:
@@ -25,11 +26,11 @@ class OutputFile {
         type(value);
     };
 
-    std::string    name() { return name_; }
+    std::string    name() const { return name_; }
 
     void           name(std::string value) { name_ = value; }
 
-    FileOutputType type() { return type_; }
+    FileOutputType type() const { return type_; }
 
     void           type(std::string value) {
         std::string ext = std::filesystem::path(value).extension().string();
@@ -42,6 +43,10 @@ class OutputFile {
             type_ = FileOutputType::Dat;
         } else if (ext == ".RAW") {
             type_ = FileOutputType::Raw;
+        } else if (ext == ".BIN") {
+            type_ = FileOutputType::Binary;
+        } else if (ext == ".JTS") {
+            type_ = FileOutputType::Store;
         } else {
             Errors::cli_errors(CLIErrors::UNKNOWN_OUTPUT_TYPE, ext);
             type_ = FileOutputType::Csv;
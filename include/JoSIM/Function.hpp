@@ -38,11 +38,17 @@ class Function {
     void                parse_function(const std::string& str, const Input& iObj, const string_o& subckt);
     double              value(double x);
     void                ampValues(std::vector<double> values);
+    void                timeValues(std::vector<double> values);
 
     std::vector<double> ampValues() { return ampValues_; }
 
     void                clearMisc() { miscValues_.clear(); }
 
+    // Draw the first sample of a noise function again, from the active noise stream
+    void                redraw_noise();
+
+    bool                is_noise() const { return fType_ == FunctionType::NOISE; }
+
 }; // class Function
 
 } // namespace JoSIM
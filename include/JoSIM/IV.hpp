@@ -8,14 +8,52 @@
 #include "Model.hpp"
 #include "Simulation.hpp"
 
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace JoSIM {
 
+/*
+  IV curves of junction models by continuation.
+
+  Every curve is traced as two branches, from rest up to the maximum current
+  and back and from rest down to the negative maximum and back. A branch is a
+  single transient of a biased junction that steps the bias from point to
+  point, so the junction state, symbolic analysis and factorizations carry
+  over. A point ends once the average voltage over two consecutive windows
+  agrees. All branches of all curves are traced on a pool of threads.
+*/
+
 class IV {
+  private:
+    // Bias step between points, time to ramp to the next point and settle before measuring
+    static constexpr double CURRENT_STEP = 2.5E-6;
+    static constexpr double RAMP_TIME    = 5E-12;
+    static constexpr double SETTLE_TIME  = 10E-12;
+    // Window over which the voltage is averaged and the longest time spent on a point
+    static constexpr double WINDOW_TIME  = 25E-12;
+    static constexpr double MAX_DWELL    = 500E-12;
+    // Agreement of consecutive window averages, relative or in volt
+    static constexpr double REL_TOL      = 5E-3;
+    static constexpr double ABS_TOL      = 1E-5;
+
+    struct Curve {
+        std::string                                           path;
+        Input                                                 input;
+        // Bias points of the positive and negative branch
+        std::array<std::vector<double>, 2>                    bias;
+        std::array<std::vector<std::pair<double, double>>, 2> data;
+    };
+
+    std::vector<Curve> curves_;
+
   public:
-    IV(const Input iObj);
-    void                                   setup_iv(const tokens_t& i, const Input& iObj);
-    std::vector<std::pair<double, double>> generate_iv(double maxC, Input ivInp);
-    std::pair<double, double>              do_simulate(Input& ivInp, Matrix& ivMat);
+    IV(const Input& iObj);
+    void setup_iv(const tokens_t& i, const Input& iObj);
+    // Trace the bias points from rest, returning the (voltage, current) of every point
+    static std::vector<std::pair<double, double>> trace_branch(const Input& ivInp, const std::vector<double>& bias);
     void write_iv(std::vector<std::pair<double, double>>& iv_data, const std::string& output_path);
 };
 
@@ -38,6 +38,7 @@ using mutualinductors = std::vector<std::pair<int64_t, double>>;
 
 class Inductor : public BasicComponent {
   private:
+    int64_t             hDepPos_ = 0;
     JoSIM::AnalysisType at_;
 
   public:
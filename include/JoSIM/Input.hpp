@@ -35,6 +35,10 @@ class Input {
     AnalysisType                                 argAnal;
     int64_t                                      argVerb;
     bool                                         argMin;
+    // Stamp large device loops on the OpenMP threads
+    bool                                         argParallel = false;
+    // Write raw output files in binary
+    bool                                         argBinary   = false;
 
     Input(AnalysisType at = AnalysisType::Phase, int64_t verb = 0, bool min = false)
         : argAnal(at), argVerb(verb), argMin(min) {};
@@ -43,6 +47,8 @@ class Input {
         argAnal                    = cli_options.analysis_type;
         argVerb                    = cli_options.verbose;
         argMin                     = cli_options.minimal;
+        argParallel                = cli_options.parallel;
+        argBinary                  = cli_options.binary;
         cli_output_file            = cli_options.output_file;
         netlist.sanityCheck        = cli_options.sanityCheck;
         netlist.sanityCheckSubckts = cli_options.sanityCheckSubckts;
@@ -51,6 +57,7 @@ class Input {
     std::vector<tokens_t> read_input(LineInput& input, string_o fileName = std::nullopt);
     void                  parse_input(string_o fileName = std::nullopt);
     void                  syntax_check_controls(std::vector<tokens_t>& controls);
+    string_o              find_option(const std::string& name) const;
 
   private:
     std::optional<uint64_t> find_seed_option() const;
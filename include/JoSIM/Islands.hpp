@@ -0,0 +1,67 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_ISLANDS_HPP
+#define JOSIM_ISLANDS_HPP
+
+#include "JoSIM/Input.hpp"
+#include "JoSIM/Matrix.hpp"
+#include "JoSIM/Simulation.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace JoSIM {
+
+/*
+  Independent simulation of the disconnected islands of a circuit.
+
+  Devices sharing a node, and inductors coupled by a mutual inductance,
+  belong to the same island. Every island creates its own Matrix from the
+  lines of the expanded netlist it holds and is simulated with its own
+  factorization, the islands running on a pool of threads. The results are
+  scattered back to the variables of the matrix of the whole circuit, which
+  writes the output as usual.
+
+  The whole circuit halves its step for all islands. An island simulated
+  with a larger step than another is simulated again with the smallest one,
+  keeping the results the same as those of the whole circuit. Circuits that
+  draw spread or noise values are simulated whole, as the islands would
+  draw them in a different order.
+*/
+
+class Islands {
+  private:
+    // Lines of the expanded netlist in every island, in netlist order
+    std::vector<std::vector<int64_t>> lines_;
+    // Island of every variable of the whole circuit
+    std::vector<int64_t>              owner_;
+    // Index of every variable of the whole circuit within the matrix of its island
+    std::vector<int64_t>              local_;
+    int64_t                           threads_ = 1;
+    // Results, statistics and final step of every island
+    std::vector<Results>              results_;
+    std::vector<SolverStats>          stats_;
+    std::vector<double>               steps_;
+
+    void run_island(const Input& iObj, const Input& base, const Matrix& mObj, int64_t k, double tstep);
+
+  public:
+    // Find the islands of the circuit in matrix mObj, created from input iObj
+    Islands(const Input& iObj, const Matrix& mObj);
+
+    // Simulating islands separately needs more than one island
+    bool    enabled() const { return lines_.size() > 1; }
+
+    int64_t size() const { return static_cast<int64_t>(lines_.size()); }
+
+    // Simulate every island and return the results of the whole circuit. The step of the input becomes the
+    // step the islands were simulated with.
+    Results run(Input& iObj, const Matrix& mObj);
+
+    // Statistics summed over the islands
+    SolverStats stats() const;
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_ISLANDS_HPP
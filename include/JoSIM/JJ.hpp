@@ -86,6 +86,10 @@ class JJ : public BasicComponent {
 
     bool   update_value(const double& v);
 
+    int64_t state() const { return state_; }
+
+    void   update_timestep(const double& factor) override;
+
     void   step_back() override {
         pn2_ = pn4_;
         vn3_ = vn6_;
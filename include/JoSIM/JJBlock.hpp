@@ -0,0 +1,110 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_JJBLOCK_HPP
+#define JOSIM_JJBLOCK_HPP
+
+#include "JoSIM/AnalysisType.hpp"
+#include "JoSIM/Components.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace JoSIM {
+
+/*
+  Junction state packed as a structure of arrays.
+
+  During a transient the history of every junction lives here instead of in
+  the JJ devices, so that the phase guess, the current phase relation and both
+  right hand side entries are evaluated in contiguous loops over all
+  junctions. Only the resistance model update and thermal noise go through the
+  devices. store() writes the history back before the devices are copied.
+  The node values are gathered by one loop per node configuration, so it is
+  not branched on per junction.
+
+  A current phase relation of harmonics a1..an is summed with the recurrence
+  sin((k+1)x) = 2cos(x)sin(kx) - sin((k-1)x), needing one sin and one cos per
+  junction regardless of n.
+
+  With parallel set, the contiguous loops run in chunks of junctions on the
+  OpenMP threads. The device updates stay on the calling thread.
+
+  The junctions can be packed by the block of a partitioned matrix holding
+  them, so the junctions of a range of blocks can be stamped on their own.
+  Their thermal noise is drawn beforehand by draw_noise(), always in netlist
+  order, so the draws do not depend on the packing or the threads.
+*/
+
+class JJBlock {
+  private:
+    std::vector<JJ*>     devices_;
+    AnalysisType         atyp_      = AnalysisType::Phase;
+    int64_t              harmonics_ = 0;
+    // Junctions by node configuration, grounded at the negative, positive or neither terminal, or at both
+    std::vector<int64_t> posGnd_, gndNeg_, posNeg_, gndGnd_;
+    // Junctions using the temperature dependent current phase relation
+    std::vector<int64_t> tDep_;
+    // Junctions with a resistance model that switches state
+    std::vector<int64_t> switching_;
+    // Junctions with thermal noise, packed and in netlist order, with their noise current of the step
+    std::vector<int64_t> noisy_, noiseOrder_;
+    std::vector<double>  noise_;
+    // First junction of every block and one past the last, if packed by block
+    std::vector<int64_t> blockStart_;
+    // sin(kx), sin((k-1)x) and 2cos(x) of the harmonic recurrence
+    std::vector<double>  sinK_, sinKm1_, twoCos_;
+    // Stamp chunks of junctions on the OpenMP threads
+    bool                 parallel_ = false;
+
+  public:
+    // Matrix indices, -1 if the terminal is grounded
+    std::vector<int64_t> pos, neg, variable, current;
+    // Phase (p) and voltage (v) history, p1 and v1 being the last step
+    std::vector<double>  p1, p2, p3, p4, v1, v2, v3, v4, v5, v6;
+    // Guessed voltage and phase of the next step
+    std::vector<double>  v0, phi0;
+    // Critical current, capacitance, phase offset, transition current and conductance (matrix entry)
+    std::vector<double>  ic, c, phiOff, it, g;
+    // Current phase relation coefficients, harmonic k of junction j at k * size() + j
+    std::vector<double>  cpr;
+    // Scratch space for the current phase relation
+    std::vector<double>  sinPhi;
+
+    int64_t size() const { return static_cast<int64_t>(devices_.size()); }
+
+    void    parallel(bool value) { parallel_ = value; }
+
+    // Pack the junctions of the given components, which must outlive the block. With blockOf, the block of every
+    // variable, the junctions of a block are packed together.
+    void    load(Components& components, AnalysisType atyp, const std::vector<int64_t>& blockOf = {});
+
+    // The junction device packed at j
+    const JJ& device(int64_t j) const { return *devices_[j]; }
+
+    // Reread the conductances after the devices changed their time step
+    void    refresh();
+
+    // Write the packed history back to the junction devices
+    void    store() const;
+
+    // Draw the thermal noise of every junction at step time, before stamping blocks
+    void    draw_noise(double step);
+
+    // Stamp the junction rows of b for step i, of the junctions of blocks [from, to)
+    // or of all of them if to is negative. Only the latter draws the thermal noise
+    // itself. Returns false if the phase guess of any junction changes by more than
+    // is allowed when checkStep is set.
+    bool    stamp(const std::vector<double>& x,
+                  std::vector<double>&       b,
+                  int64_t                    i,
+                  double                     step,
+                  double                     h,
+                  bool                       checkStep,
+                  bool&                      needsLU,
+                  int64_t                    from = 0,
+                  int64_t                    to   = -1);
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_JJBLOCK_HPP
@@ -0,0 +1,72 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_LOWRANK_HPP
+#define JOSIM_LOWRANK_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace JoSIM {
+
+/*
+  Sherman-Morrison-Woodbury correction of an existing LU factorization.
+
+  The factorized matrix A differs from the current matrix A' in m entries:
+  A' = A + U D V^T, with U = [e_r1 .. e_rm], V = [e_c1 .. e_cm] and
+  D = diag(d1 .. dm) the changes in value. Then
+
+    x = y - Z S^-1 V^T y,  y = A^-1 b,  Z = A^-1 U,  S = D^-1 + V^T Z
+
+  Z is only computed when an entry is first changed, leaving one base solve
+  plus an m x m dense solve per time step.
+*/
+
+class LowRankUpdate {
+  private:
+    int64_t                          size_ = 0;
+    std::vector<double>              baseNz_;
+    std::vector<int64_t>             nzRow_, nzCol_;
+    std::vector<int64_t>             pos_;
+    std::vector<double>              delta_;
+    std::vector<std::vector<double>> z_;
+    std::vector<double>              s_;
+    std::vector<int64_t>             piv_;
+
+    bool                             factor_capacitance();
+
+  public:
+    using solver_t = std::function<void(std::vector<double>&)>;
+
+    // Store the values and structure of the matrix that was just factorized
+    template<typename T>
+    void reset(const std::vector<double>& nz, const std::vector<T>& ci, const std::vector<T>& rp) {
+        size_   = static_cast<int64_t>(rp.size());
+        baseNz_ = nz;
+        nzRow_.resize(nz.size());
+        nzCol_.assign(ci.begin(), ci.end());
+        for (int64_t r = 0; r < static_cast<int64_t>(rp.size()) - 1; ++r) {
+            for (auto j = rp.at(r); j < rp.at(r + 1); ++j) { nzRow_.at(j) = r; }
+        }
+        clear();
+    }
+
+    // Drop all pending corrections
+    void clear();
+
+    // Gather the entries that differ from the factorized matrix. Returns false if
+    // more than maxRank entries differ or the correction is unstable, in which case
+    // the caller should refactorize.
+    bool update(const std::vector<double>& nz, int64_t maxRank, const solver_t& solve);
+
+    // Apply the correction to a solution of the factorized matrix
+    void correct(std::vector<double>& x) const;
+
+    bool empty() const { return pos_.empty(); }
+
+    int64_t rank() const { return static_cast<int64_t>(pos_.size()); }
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_LOWRANK_HPP
@@ -0,0 +1,88 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_MARGIN_HPP
+#define JOSIM_MARGIN_HPP
+
+#include "JoSIM/Input.hpp"
+#include "JoSIM/Output.hpp"
+#include "JoSIM/ParameterName.hpp"
+#include "JoSIM/Simulation.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace JoSIM {
+
+/*
+  Margin analysis of the parameters listed by .margin controls.
+
+  A probe scales one parameter of the parsed netlist, parses the parameters
+  again and simulates the result. It passes when every trace named by a
+  .pass control stays within its tolerance of the nominal waveform, or
+  switches its phase by 2pi as often as required, over the whole transient.
+  Without .pass controls it passes when the final value of every stored
+  phase is within pi of the nominal run. The lower and upper margin of every
+  parameter are bisected as separate tasks on a pool of threads.
+*/
+
+class Margin {
+  private:
+    struct Result {
+        double nominal = 0.0;
+        // Relative margins below and above the nominal value
+        double lower   = 0.0;
+        double upper   = 0.0;
+    };
+
+    // Condition a probe has to meet on one trace of the nominal output
+    struct Check {
+        int64_t  trace    = 0;
+        // Largest deviation from the nominal trace, over the whole waveform or only at its end
+        double_o tol;
+        bool     whole    = true;
+        // Number of 2pi switches over the waveform, if there is no tolerance
+        int64_t  switches = 0;
+    };
+
+    // Traces named by a .pass control and its tolerance or switch count (the nominal count if neither is given)
+    struct Criterion {
+        std::vector<std::string> traces;
+        double_o                 tol;
+        int_o                    switches;
+    };
+
+    std::vector<ParameterName> params_;
+    std::vector<Result>        results_;
+    // Largest relative change probed and the resolution of the bisection
+    double                     range_      = 0.9;
+    double                     resolution_ = 0.005;
+    int64_t                    threads_    = 1;
+    std::vector<Criterion>     criteria_;
+    // Nominal output and the checks every probe is compared to it with
+    Output                     nominal_;
+    std::vector<Check>         checks_;
+
+    // Symbolic analysis of the nominal matrix, shared by all probes
+    std::unique_ptr<SharedSymbolic> symbolic_;
+
+    bool probe(const Input& iObj, int64_t param, double factor) const;
+    void bisect(const Input& iObj, int64_t task);
+
+  public:
+    // Read the .margin and .pass controls and the MARGINRANGE, MARGINRES and THREADS options
+    Margin(const Input& iObj);
+
+    bool enabled() const { return !params_.empty(); }
+
+    // Simulate the nominal netlist and bisect every margin
+    void run(const Input& iObj);
+
+    // Write the margins to the output file of the command line, or to the terminal
+    void write_margins(const Input& iObj) const;
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_MARGIN_HPP
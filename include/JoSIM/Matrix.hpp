@@ -10,6 +10,7 @@
 #include "JoSIM/RelevantTrace.hpp"
 #include "JoSIM/Spread.hpp"
 
+#include <random>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -19,6 +20,11 @@ class Matrix {
   private:
     std::vector<NodeConfig> nodeConfig, nodeConfig2;
     bool                    needsTR_ = true;
+    // Devices, sources and noise streams as created, restored when retiming
+    Components              initialComponents_;
+    std::vector<Function>   initialSourcegen_;
+    std::mt19937_64         initialNoise_, initialSpread_;
+    double                  initialStep_ = 0.0;
 
   public:
     AnalysisType                             analysisType = AnalysisType::Phase;
@@ -45,6 +51,7 @@ class Matrix {
     void create_components(Input& iObj);
     void handle_mutual_inductance(Input& iObj);
     void reduce_step(Input& iObj);
+    void retime(Input& iObj);
     void create_csr();
     void create_nz();
     void create_ci();
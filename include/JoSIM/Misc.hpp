@@ -8,6 +8,7 @@
 #include "JoSIM/TypeDefines.hpp"
 
 #include <algorithm>
+#include <array>
 #include <iomanip>
 #include <map>
 #include <regex>
@@ -72,6 +73,12 @@ namespace Misc {
 
     int64_t numDigits(int64_t number);
 
+    // Four point Lagrange weights at x for the given nodes
+    std::array<double, 4> lagrange_weights(const std::array<double, 4>& nodes, double x);
+
+    // First of the four samples around fractional position p on a uniform grid of n >= 4 samples
+    int64_t stencil(int64_t n, double p);
+
     double  grand();
 } // namespace Misc
 } // namespace JoSIM
@@ -43,7 +43,7 @@ class Model {
 
     void                ic(const double& i) { ic_ = i; }
 
-    std::vector<double> cpr() const { return cpr_; }
+    const std::vector<double>& cpr() const { return cpr_; }
 
     void                cpr(const std::vector<double>& i) { cpr_ = i; }
 
@@ -87,7 +87,7 @@ class Model {
 
     void                phiOff(const double& o) { phiOff_ = o; }
 
-    bool                tDep() { return tDep_; }
+    bool                tDep() const { return tDep_; }
 
     void                tDep(bool b) { tDep_ = b; }
 
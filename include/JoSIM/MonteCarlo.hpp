@@ -0,0 +1,53 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_MONTECARLO_HPP
+#define JOSIM_MONTECARLO_HPP
+
+#include "JoSIM/Input.hpp"
+#include "JoSIM/Output.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace JoSIM {
+
+/*
+  Monte Carlo analysis of the SPREAD and noise values of a netlist.
+
+  The netlist is parsed and expanded once. Every sample then creates its own
+  Matrix and Simulation from a copy of the input, drawing its spread and noise
+  values from the streams Rng::derive gives for the sample index. Samples run
+  on a pool of threads, and since the streams only depend on the index the
+  results do not depend on the number of threads. Sample 0 repeats the run
+  without Monte Carlo analysis.
+
+  The summary holds one row per sample with the final value of every trace.
+*/
+
+class MonteCarlo {
+  private:
+    int64_t                          samples_ = 0;
+    int64_t                          threads_ = 1;
+    // Final value of every trace, by sample
+    std::vector<std::vector<double>> rows_;
+    // Traces of sample 0, giving the names and files of the summary columns
+    std::vector<Trace>               traces_;
+
+    void run_sample(const Input& iObj, int64_t sample);
+
+  public:
+    // Read the MC and THREADS options of the input
+    MonteCarlo(const Input& iObj);
+
+    bool enabled() const { return samples_ > 0; }
+
+    // Simulate every sample
+    void run(const Input& iObj);
+
+    // Write the summary to the output files of the input, or to the terminal
+    void write_summary(const Input& iObj) const;
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_MONTECARLO_HPP
@@ -12,6 +12,7 @@ namespace JoSIM {
 class Trace {
   public:
     std::string         name_;
+    // T(ime), V(oltage), P(hase), I (current) or S(weep), sweep columns are written to every file
     char                type_;
     int64_t             fileIndex = -1;
     std::vector<double> data_;
@@ -25,15 +26,32 @@ class Output {
   public:
     std::vector<Trace>  traces;
     std::vector<double> timesteps;
+    // Ensemble instance written, instances after the first add _k to the file names
+    int64_t             instance = 0;
     Output() {};
-    Output(Input& iObj, Matrix& mObj, Simulation& sObj);
+    Output(Input& iObj, Matrix& mObj, Simulation& sObj, int64_t instance = 0);
+    // Write and format results that were not simulated with the matrix itself, as merged from circuit islands
+    Output(Input& iObj, Matrix& mObj, const Results& results);
     void write_output(const Input& iObj, Matrix& mObj, Simulation& sObj);
+    void write_output(const Input& iObj, Matrix& mObj, const Results& results);
+
+    // Labels of the traces filtered while simulating, the relevant traces or every node if there are none
+    static std::vector<Trace> labels(const Input& iObj, const Matrix& mObj);
+
+    // Write the traces to the output files of the input, or to the terminal if there are none
+    void format_output(const Input& iObj);
 
     void format_csv_or_dat(const std::string& filename, const char& delimiter, bool argmin = true, int64_t fIndex = -1);
 
-    void format_raw(const std::string& filename, bool argmin = true, int64_t fIndex = -1);
+    // Values are written as text or, if binary, as little endian doubles point by point
+    void format_raw(const std::string& filename, bool argmin = true, int64_t fIndex = -1, bool binary = false);
+
+    // Write the traces to a native trace store, one column per trace
+    void format_store(const std::string& filename, int64_t fIndex = -1);
 
     void format_cout(const bool& argMin);
+
+    std::string instance_name(const std::string& filename) const;
 };
 } // namespace JoSIM
 
@@ -0,0 +1,61 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_PSS_HPP
+#define JOSIM_PSS_HPP
+
+#include "JoSIM/AnalysisType.hpp"
+#include "JoSIM/Input.hpp"
+#include "JoSIM/Matrix.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace JoSIM {
+
+class Simulation;
+
+/*
+  Periodic steady state of a clocked circuit.
+
+  The state at the start of a period, the window of solutions the device
+  history is replayed from, is simulated over one clock period and the
+  state at its end becomes the start of the next period. Phases that
+  advance by whole turns every period are brought back by those turns, so
+  a circuit passing a fluxon every cycle still repeats. The iterations are
+  accelerated by combining the last few periods (Anderson acceleration)
+  and stop once the state no longer changes over a period. The results
+  hold the last period.
+*/
+
+class PSS {
+  private:
+    static constexpr int64_t DEFAULT_ITERATIONS = 50;
+    static constexpr double  DEFAULT_TOL        = 1E-6;
+    // Periods combined by the acceleration
+    static constexpr int64_t MEMORY             = 5;
+    static constexpr double  ROUNDING           = 1E-12;
+
+    // Clock period (0 runs a plain transient) and the time the iterated period starts at
+    double                   period_            = 0.0;
+    double                   start_             = 0.0;
+    double                   tol_               = DEFAULT_TOL;
+    int64_t                  iterations_        = DEFAULT_ITERATIONS;
+
+    // Groups of variables advancing by the same whole turns every period
+    static std::vector<std::vector<int64_t>> turn_groups(const Matrix& mObj, AnalysisType atyp);
+
+  public:
+    // Read the periodic steady state options of input iObj
+    void load(const Input& iObj);
+
+    bool enabled() const { return period_ > 0; }
+
+    void disable() { period_ = 0.0; }
+
+    // Find the periodic steady state of sim, falling back to a plain transient if the period is too short
+    void run(Simulation& sim, Matrix& mObj) const;
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_PSS_HPP
@@ -0,0 +1,62 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_PARALLEL_HPP
+#define JOSIM_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace JoSIM {
+
+/*
+  Device loops split into contiguous chunks on the OpenMP threads.
+
+  Only available when compiled with USING_OPENMP and enabled with the -p
+  switch. Every chunk writes its own devices and right hand side rows, so
+  the results do not depend on the number of threads. Loops shorter than
+  two chunks run on the calling thread.
+
+  Independent tasks of uneven cost, such as the blocks of a partitioned
+  matrix, are handed to the threads one at a time instead.
+*/
+
+class Parallel {
+  public:
+    // Fewest devices worth handing to a thread
+    static constexpr int64_t MIN_CHUNK = 1024;
+
+    // Call body(begin, end) over contiguous chunks covering [0, count)
+    template<typename Body>
+    static void chunks(bool enabled, int64_t count, const Body& body) {
+#ifdef _OPENMP
+        if (enabled && count >= 2 * MIN_CHUNK && omp_get_max_threads() > 1) {
+            int64_t parts = std::min(static_cast<int64_t>(omp_get_max_threads()), count / MIN_CHUNK);
+#pragma omp parallel for schedule(static) num_threads(parts)
+            for (int64_t k = 0; k < parts; ++k) { body(k * count / parts, (k + 1) * count / parts); }
+            return;
+        }
+#endif
+        body(static_cast<int64_t>(0), count);
+    }
+
+    // Call body(k) for every k in [0, count), the threads taking the next task as they become free
+    template<typename Body>
+    static void tasks(bool enabled, int64_t count, const Body& body) {
+#ifdef _OPENMP
+        if (enabled && count > 1 && omp_get_max_threads() > 1) {
+#pragma omp parallel for schedule(dynamic)
+            for (int64_t k = 0; k < count; ++k) { body(k); }
+            return;
+        }
+#endif
+        for (int64_t k = 0; k < count; ++k) { body(k); }
+    }
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_PARALLEL_HPP
@@ -0,0 +1,66 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_PARAREAL_HPP
+#define JOSIM_PARAREAL_HPP
+
+#include "JoSIM/Input.hpp"
+#include "JoSIM/Matrix.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace JoSIM {
+
+class Simulation;
+
+/*
+  Parallel-in-time transient.
+
+  The transient is cut into slices starting on the grid of a coarse
+  propagator, which takes steps of several transient steps. The coarse
+  propagator predicts the state every slice starts from, fine propagators
+  simulate the slices from those states on a pool of threads, and the
+  difference between the fine and coarse solutions corrects the next
+  prediction. The iterations stop once the slice boundaries no longer
+  change, every iteration making at least one more slice exact. A state is
+  the window of solutions the device history is replayed from.
+*/
+
+class Parareal {
+  private:
+    static constexpr int64_t DEFAULT_COARSE_STRIDE = 8;
+    static constexpr double  DEFAULT_TOL           = 1E-6;
+    static constexpr double  ROUNDING              = 1E-12;
+
+    // Slices of the transient (0 runs it serially), the threads simulating them and the coarse step in steps
+    int64_t                  slices_               = 0;
+    int64_t                  threads_              = 1;
+    int64_t                  coarseStride_         = DEFAULT_COARSE_STRIDE;
+    double                   tol_                  = DEFAULT_TOL;
+
+  public:
+    // Read the Parareal options of input iObj
+    void    load(const Input& iObj);
+
+    bool    enabled() const { return slices_ > 1; }
+
+    void    disable() { slices_ = 0; }
+
+    // Simulate the transient of sim in slices, falling back to a serial transient if the slices are too short
+    void    run(Simulation& sim, Input& iObj, Matrix& mObj) const;
+
+    // Step sim from the window of solutions ending at step first to step last, storing the steps in its results if
+    // store is set. Returns the width solutions ending at step last, newest first, or nothing if the step has to
+    // be reduced. The first slice starts at rest from an empty window.
+    static std::vector<std::vector<double>> propagate(Simulation&                             sim,
+                                                      Matrix&                                 mObj,
+                                                      const std::vector<std::vector<double>>& window,
+                                                      int64_t                                 first,
+                                                      int64_t                                 last,
+                                                      bool                                    store,
+                                                      int64_t                                 width);
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_PARAREAL_HPP
@@ -0,0 +1,104 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef SLU
+#    ifndef JOSIM_PARTITIONS_HPP
+#        define JOSIM_PARTITIONS_HPP
+
+#        include "JoSIM/Matrix.hpp"
+
+#        include <suitesparse/klu.h>
+
+#        include <cstdint>
+#        include <vector>
+
+namespace JoSIM {
+
+/*
+  System matrix factored as independent diagonal blocks.
+
+  A transmission line with a delay of at least one step couples its two
+  ports only through the right hand side, its rows share no matrix entry.
+  The parts of a circuit joined only by transmission lines are therefore
+  independent blocks of the matrix, exchanging their waveforms through the
+  delayed values of the lines. Every block is analyzed and factored on its
+  own, a junction switching only refactors the block holding it, and the
+  blocks are factored and solved on the OpenMP threads if enabled.
+
+  A block can also be refactored and solved on its own, so that a caller
+  assembling the right hand side rows of every block in a task of its own
+  can solve the block in the same task.
+*/
+
+class Partitions {
+  private:
+    struct Block {
+        // Variables of the block in ascending order, and the block rows in the compressed storage of the matrix
+        std::vector<int64_t> rows;
+        std::vector<int64_t> rp, ci;
+        // Position in the matrix non zeros of every block entry, and the values last factored
+        std::vector<int64_t> entries;
+        std::vector<double>  nz;
+        std::vector<double>  x;
+        klu_l_common         common;
+        klu_l_symbolic*      symbolic = nullptr;
+        klu_l_numeric*       numeric  = nullptr;
+        // Reciprocal condition estimate of the last full factorization
+        double               rcond    = 0.0;
+    };
+
+    std::vector<Block> blocks_;
+    // Outcome of the last operation on every block
+    std::vector<char>  state_;
+    bool               parallel_ = false;
+
+    static bool        factor(Block& b);
+    // Refactor block b if its entries changed, returning the state refactor() reports
+    static char        refactor(Block& b, const Matrix& mObj, double tolerance);
+
+  public:
+    Partitions() = default;
+    ~Partitions() { clear(); }
+    Partitions(const Partitions&)            = delete;
+    Partitions& operator=(const Partitions&) = delete;
+
+    // Split the sparsity pattern of the matrix into blocks sharing no entry, enabled if there is more than one
+    void        load(const Matrix& mObj);
+
+    bool        enabled() const { return blocks_.size() > 1; }
+
+    int64_t     size() const { return static_cast<int64_t>(blocks_.size()); }
+
+    // Factor and solve the blocks on the OpenMP threads
+    void        parallel(bool enabled) { parallel_ = enabled; }
+
+    // Factor every block
+    void        factorize(const Matrix& mObj);
+
+    // Refactor the blocks whose entries changed, using their previous pivot order unless the pivots degrade below
+    // the given fraction of those of the last full factorization. Returns whether every block kept its pivot order.
+    bool        refactorize(const Matrix& mObj, double tolerance);
+
+    // Solve in place for right hand side x
+    void        solve(std::vector<double>& x);
+
+    // Block of every variable
+    std::vector<int64_t>        block_of() const;
+
+    // Variables of block k in ascending order
+    const std::vector<int64_t>& rows(int64_t k) const { return blocks_.at(k).rows; }
+
+    // Refactor block k if its entries changed, as refactorize() does. Returns 0 if it is unchanged or kept its pivot
+    // order, 1 if it is singular and 2 if it was factored again.
+    char                        refactor(int64_t k, const Matrix& mObj, double tolerance);
+
+    // Solve block k for its rows of b, writing its rows of x. Returns false if the block is singular.
+    bool                        solve(int64_t k, const std::vector<double>& b, std::vector<double>& x);
+
+    // Free the analyses and factorizations of all blocks
+    void        clear();
+};
+
+} // namespace JoSIM
+
+#    endif // JOSIM_PARTITIONS_HPP
+#endif     // SLU
@@ -55,6 +55,8 @@ class RelevantTrace {
 }; // class RelevantTrace
 
 void find_relevant_traces(Input& iObj, Matrix& mObj);
+// Indices to store for the relevant traces and the transmission lines
+void find_relevant_indices(Matrix& mObj);
 void handle_current(const std::string& s, Matrix& mObj, int64_t fIndex);
 void handle_voltage_or_phase(const std::string& s, bool voltage, Matrix& mObj, int64_t fIndex);
 
@@ -10,11 +10,31 @@ namespace JoSIM {
 
 class Rng {
   public:
+    struct BMState {
+        bool   hasSpare = false;
+        double spare    = 0.0;
+    };
+
+    // Noise and spread streams of one run, with the spare normal of the noise stream
+    struct Streams {
+        uint64_t        seed = 0;
+        std::mt19937_64 noise;
+        std::mt19937_64 spread;
+        BMState         noiseSpare;
+    };
+
     static void             start_run_auto();
     static void             start_run(uint64_t seed);
     static void             rewind();
     static uint64_t         base_seed();
 
+    // Independent streams of run index k derived from the streams in use, index 0 repeats their seed
+    static Streams          derive(uint64_t index);
+
+    // Draw from the given streams on the calling thread, nullptr returns to the streams of start_run.
+    // Returns the streams used before, to be restored afterwards.
+    static Streams*         use(Streams* streams);
+
     // Separate deterministic streams
     static std::mt19937_64& noise();
     static std::mt19937_64& spread();
@@ -26,17 +46,14 @@ class Rng {
     static double           normal_spread(double mean, double sigma);
 
   private:
-    struct BMState {
-        bool   hasSpare = false;
-        double spare    = 0.0;
-    };
-
-    static double                 normal01_(std::mt19937_64& eng, BMState& st);
-
-    static inline bool            seeded_ = false;
-    static inline uint64_t        seed_   = 0;
-    static inline std::mt19937_64 noise_;
-    static inline std::mt19937_64 spread_;
+    static double                       normal01_(std::mt19937_64& eng, BMState& st);
+    static void                         seed_streams(Streams& streams, uint64_t seed);
+    static Streams&                     active();
+
+    static inline bool                  seeded_ = false;
+    static inline uint64_t              seed_   = 0;
+    static Streams                      streams_;
+    static inline thread_local Streams* active_ = nullptr;
 };
 
 } // namespace JoSIM
@@ -3,12 +3,26 @@
 #ifndef JOSIM_SIMULATION_HPP
 #define JOSIM_SIMULATION_HPP
 
+#include "JoSIM/Decimator.hpp"
 #include "JoSIM/Errors.hpp"
+#include "JoSIM/FactorCache.hpp"
+#include "JoSIM/JJBlock.hpp"
 #include "JoSIM/LUSolve.hpp"
+#include "JoSIM/LowRank.hpp"
 #include "JoSIM/Matrix.hpp"
 #include "JoSIM/Misc.hpp"
+#include "JoSIM/PSS.hpp"
+#include "JoSIM/Parareal.hpp"
+#include "JoSIM/Partitions.hpp"
+#include "JoSIM/Rng.hpp"
+#include "JoSIM/StampPlan.hpp"
+#include "JoSIM/Stream.hpp"
 
+#include <array>
 #include <cassert>
+#include <functional>
+#include <optional>
+#include <random>
 #include <suitesparse/klu.h>
 
 namespace JoSIM {
@@ -23,48 +37,298 @@ class Results {
   public:
     std::vector<std::optional<std::vector<double>>> xVector;
     std::vector<double>                             timeAxis;
+    // Traces filtered at the print times while simulating, in the order they are written (empty if the steps
+    // were stored instead)
+    std::vector<double>                             printTimes;
+    std::vector<std::vector<double>>                printTraces;
 };
 
+class SolverStats {
+  public:
+    // Full numeric factorizations (new pivot order)
+    int64_t factorizations     = 0;
+    // Numeric refactorizations reusing the existing pivot order
+    int64_t refactorizations   = 0;
+    // Matrix changes absorbed as a low-rank correction without refactoring
+    int64_t lowRankUpdates     = 0;
+    // Junction state changes served from the factorization cache
+    int64_t cacheHits          = 0;
+    // Junction state changes that required a new factorization
+    int64_t cacheMisses        = 0;
+    // Halvings of the step size after a junction phase step was too large
+    int64_t stepReductions     = 0;
+    // Halvings resumed from a checkpoint instead of t=0
+    int64_t checkpointResumes  = 0;
+    // Accepted transient steps
+    int64_t timeSteps          = 0;
+    // Adaptive steps repeated with half the step size
+    int64_t rejectedSteps      = 0;
+    // Parareal iterations until the slice boundaries converged (0 for a serial transient)
+    int64_t pararealIterations = 0;
+    // Time of the first fine sweep as if run serially, over the wall time of the Parareal transient
+    double  pararealSpeedup    = 0.0;
+    // Blocks of a matrix factored apart (0 if factored whole)
+    int64_t partitions         = 0;
+    // Periods simulated until the periodic steady state converged (0 for a plain transient)
+    int64_t pssIterations      = 0;
+
+    // Add the work done by another simulation, such as the propagators of a Parareal transient
+    void    add(const SolverStats& other);
+};
+
+class Checkpoint {
+  public:
+    // Transient step index, transient step size and stride of the step this checkpoint was taken after
+    int64_t                          step     = 0;
+    double                           baseStep = 0.0;
+    int64_t                          stride   = 1;
+    // Number of stored results up to and including this step
+    int64_t                          results  = 0;
+    // Solutions of the last few steps, newest first
+    std::vector<std::vector<double>> x;
+    // Device history, source state and noise streams
+    Components                       components;
+    std::vector<Function>            sourcegen;
+    std::mt19937_64                  noise, spread;
+};
+
+class EnsembleInstance {
+  public:
+    // Device history, source state and noise streams
+    Components            components;
+    std::vector<Function> sourcegen;
+    Rng::Streams          rng;
+    // Solution and the packed state derived from the components
+    std::vector<double>   x;
+    JJBlock               jjBlock;
+    StampPlan             stampPlan;
+    Results               results;
+};
+
+// Symbolic analysis of a sparsity pattern, shared by the simulations of netlists that only differ in values.
+// The analysis is only read while factoring and solving, so simulations on other threads can share it.
+class SharedSymbolic {
+  private:
+    std::vector<int64_t> ci_, rp_;
+#ifndef SLU
+    klu_l_common    common_;
+    klu_l_symbolic* symbolic_ = nullptr;
+#endif
+
+  public:
+    SharedSymbolic(const Matrix& mObj);
+    ~SharedSymbolic();
+    SharedSymbolic(const SharedSymbolic&)            = delete;
+    SharedSymbolic& operator=(const SharedSymbolic&) = delete;
+
+    bool matches(const Matrix& mObj) const { return mObj.ci == ci_ && mObj.rp == rp_; }
+#ifndef SLU
+    klu_l_symbolic* symbolic() const { return symbolic_; }
+#endif
+};
+
+// Called with the time and solution of every accepted step of a single instance transient. The transient ends
+// once it returns false. Steps given to a monitor are not stored in the results.
+using StepMonitor = std::function<bool(double, const std::vector<double>&)>;
+
 class Simulation {
+    // The analyses stepping the transient in pieces
+    friend class Parareal;
+    friend class PSS;
+
   private:
     bool                SLU = false;
     std::vector<double> x_, b_;
     int64_t             simSize_;
     JoSIM::AnalysisType atyp_;
     bool                minOut_;
+    // Stamp large device loops on the OpenMP threads
+    bool                parallel_ = false;
     bool                needsLU_;
     bool                needsTR_ = true;
     bool                startup_;
-    double              stepSize_, prstep_, prstart_;
+    double              stepSize_, baseStep_, prstep_, prstart_;
 #ifdef SLU
     LUSolve lu;
 #else
     int64_t         simOK_;
     klu_l_symbolic* Symbolic_;
+    // The symbolic analysis is freed with the simulation unless it is shared
+    bool            ownsSymbolic_ = true;
     klu_l_common    Common_;
-    klu_l_numeric*  Numeric_;
+    klu_l_numeric*  Numeric_ = nullptr;
+    // Reciprocal condition estimate of the last full factorization
+    double          factorRcond_ = 0.0;
+    // Factorizations of previously seen junction states (disabled if capacity is 0)
+    FactorCache     factorCache_;
+    // Blocks of the matrix sharing no entry, factored apart (disabled if there is a single block)
+    Partitions      partitions_;
+#endif
+    // Refactorizations whose pivot quality drops below this fraction of the last full factorization fall back
+    static constexpr double PIVOT_TOLERANCE = 1E-3;
+    // Maximum pending entries corrected before refactoring (0 disables)
+    int64_t                 lowRankMax_     = 0;
+    LowRankUpdate           lowRank_;
+    // Packed junction state, authoritative over the JJ devices during a transient
+    JJBlock                 jjBlock_;
+    // Compiled right hand side stamps of the linear devices (disabled stamps device by device)
+    StampPlan               stampPlan_;
+    // A device and the matrix indices of one of its ends, -1 if grounded
+    struct Terminal {
+        int64_t device, pos, neg;
+    };
+    // Terminals by node configuration, grounded at the negative, positive or neither end, or at both
+    struct TerminalGroups {
+        std::vector<Terminal> posGnd, gndNeg, posNeg, gndGnd;
+        void                  add(int64_t device, const int_o& pos, const int_o& neg);
+    };
+    // Current sources and both ends of the transmission lines, so their stamps loop per node configuration
+    TerminalGroups                csTerminals_;
+    std::array<TerminalGroups, 2> txTerminals_;
+    // Block of every variable if every block of the partitioned matrix is assembled and solved in a task of its
+    // own. Only partitioned matrices compiled into a stamp plan and stepped in parallel with a fixed step are.
+    std::vector<int64_t>          blockOf_;
+#ifndef SLU
+    // Consecutive blocks [from, to) of the partitioned matrix assembled and solved in one task, and their devices
+    struct BlockTask {
+        int64_t                                  from, to;
+        // Junctions packed in jjBlock_ with the position of their conductance in the matrix non zeros
+        std::vector<std::pair<int64_t, int64_t>> junctions;
+        std::vector<int64_t>                     phaseSources;
+        // Transmission line ends by node configuration, and every line with the end it stamps
+        std::array<TerminalGroups, 2>            txTerminals;
+        std::vector<std::pair<int64_t, int64_t>> txEnds;
+    };
+    std::vector<BlockTask>        blockTasks_;
 #endif
 
+    // Device history steps rebuilt when resuming or changing the step size, and the solutions kept for it
+    static constexpr int64_t         REPLAY_STEPS  = 6;
+    static constexpr int64_t         HISTORY_DEPTH = 2 * REPLAY_STEPS + 1;
+    // Steps between checkpoints (0 disables, halving then restarts from t=0)
+    int64_t                          checkpointInterval_ = 0;
+    std::optional<Checkpoint>        checkpoint_;
+    std::vector<std::vector<double>> history_;
+    int64_t                          historyCount_ = 0;
+    // Last step restored from a checkpoint, the transient continues after it
+    std::optional<int64_t>           resume_;
+
+    // Junction phase error tolerance of adaptive steps (0 uses the fixed transient step)
+    static constexpr int64_t DEFAULT_MAX_STRIDE = 64;
+    double                   lteTol_            = 0.0;
+    // Steps are stride_ transient steps long, up to maxStride_
+    int64_t                  stride_            = 1;
+    int64_t                  maxStride_         = DEFAULT_MAX_STRIDE;
+    // Consecutive steps well within tolerance
+    int64_t                  quiet_             = 0;
+
+    // Receives the accepted steps instead of the results, if given
+    StepMonitor                      monitor_;
+    // Filters the traces at the print times instead of storing every step (disabled stores the steps)
+    Decimator                        decimator_;
+    // Writes the filtered traces to the output files while simulating, if given and the traces are filtered
+    Stream*                          stream_ = nullptr;
+
+    // Parallel-in-time transient and periodic steady state, run instead of the serial transient if enabled
+    Parareal parareal_;
+    PSS      pss_;
+    // Coarse propagators take steps the junction phase check would reject
+    bool     checkStep_ = true;
+
+    // Instances advanced in lockstep with this one, sharing its matrix (empty runs a single instance)
+    static constexpr int64_t      DEFAULT_ENSEMBLE_CACHE = 256;
+    std::vector<EnsembleInstance> ensemble_;
+    // Netlists of the instances after the first if they differ in their sources rather than their noise draws
+    std::vector<Matrix>*          variants_ = nullptr;
+    // Junction state signature of every instance and of the current factorization
+    std::vector<std::string>      signatures_;
+    std::string                   factorSignature_;
+    // Right hand sides of all instances, column major
+    std::vector<double>           block_;
+
     void setup(Input& iObj, Matrix& mObj);
     void trans_sim(Matrix& mObj);
+    int64_t startup_steps() const;
     void setup_b(Matrix& mObj, int64_t i, double step, double factor = 1);
+    // Assemble and solve step i at time step, in a task per block if partitioned
+    void advance(Matrix& mObj, int64_t i, double step);
+#ifndef SLU
+    // Group the blocks of the partitioned matrix into tasks and collect their devices
+    void setup_blocks(const Matrix& mObj);
+    void advance_blocks(Matrix& mObj, int64_t i, double step);
+#endif
     void reduce_step(Input& iObj, Matrix& mObj);
+    void take_checkpoint(Matrix& mObj, int64_t i);
+    bool restore_checkpoint(Input& iObj, Matrix& mObj);
+    void push_history();
+    std::vector<std::vector<double>> recent_history() const;
+    int64_t replay_steps(int64_t count, double windowStep, double step, int64_t last, int64_t stride) const;
+    bool    rebuild_history(Matrix&                                 mObj,
+                            const std::vector<std::vector<double>>& window,
+                            double                                  windowStep,
+                            int64_t                                 last);
+    void    set_stride(Matrix& mObj, int64_t stride);
+    bool    shrink_step(Matrix& mObj, int64_t last);
+    void    adapt_step(Matrix& mObj, int64_t i);
+    double  junction_lte() const;
+    void    resample_results();
+    void    setup_ensemble(Matrix& mObj, int64_t size);
+    void    swap_instance(Matrix& mObj, int64_t k);
+    bool    ensemble_step(Matrix& mObj, int64_t i, bool store);
+    void    trans_sim_ensemble(Matrix& mObj);
+    bool    has_noise(const Matrix& mObj) const;
+    // Propagator of a Parareal transient, sharing the symbolic analysis of its parent
+    Simulation(Input& iObj, Matrix& mObj, const Simulation& parent, int64_t stride);
+    void release();
+    void factorize(Matrix& mObj);
+    void refactorize(Matrix& mObj);
+    bool cached_factorization(Matrix& mObj);
+    void base_solve(Matrix& mObj, std::vector<double>& x);
+    void base_solve(Matrix& mObj, double* block, int64_t nrhs);
+    void solve(Matrix& mObj);
 
+    // Group the current sources and transmission line ends by node configuration
+    void group_terminals(const Matrix& mObj);
     void handle_cs(Matrix& mObj, double& step, const int64_t& i);
     void handle_resistors(Matrix& mObj, double& step);
     void handle_inductors(Matrix& mObj, double factor = 1);
     void handle_capacitors(Matrix& mObj);
     void handle_jj(Matrix& mObj, int64_t& i, double& step, double factor = 1);
     void handle_vs(Matrix& mObj, const int64_t& i, double& step, double factor = 1);
-    void handle_ps(Matrix& mObj, const int64_t& i, double& step, double factor = 1);
+    void handle_ps(
+            Matrix& mObj, const std::vector<int64_t>& indices, const int64_t& i, double& step, double factor = 1);
     void handle_ccvs(Matrix& mObj);
     void handle_vccs(Matrix& mObj);
     void handle_tx(Matrix& mObj, const int64_t& i, double& step, double factor = 1);
+    // Keep the phases of the last step across the given transmission line ends
+    void gather_tx(Matrix& mObj, const std::array<TerminalGroups, 2>& terminals);
+    // Stamp the current row of end 0 or 1 of a transmission line
+    void stamp_tx_end(TransmissionLine& temp, int64_t end, int64_t i, double factor = 1);
+    // Keep the solution of step i as delayed values of the transmission lines
+    void store_tx(Matrix& mObj, int64_t i);
+
+    std::string junction_signature(const Matrix& mObj) const;
 
   public:
-    Results results;
+    Results     results;
+    SolverStats stats;
+
+    // Simulate the matrix, reusing the shared symbolic analysis if given and of the same sparsity pattern. The
+    // output files are written by stream while simulating if it is enabled and the traces can be filtered. The
+    // variants, matrices with the nonzeros of mObj that differ in their sources or other right hand side values,
+    // are simulated as further ensemble instances.
+    Simulation(Input&                iObj,
+               Matrix&               mObj,
+               const SharedSymbolic* symbolic = nullptr,
+               StepMonitor           monitor  = nullptr,
+               Stream*               stream   = nullptr,
+               std::vector<Matrix>*  variants = nullptr);
+
+    // Number of instances simulated, 1 unless an ensemble was requested
+    int64_t        ensemble_size() const { return static_cast<int64_t>(ensemble_.size()) + 1; }
 
-    Simulation(Input& iObj, Matrix& mObj);
+    // Results of instance k of the ensemble, instance 0 being results
+    const Results& instance_results(int64_t k) const { return k == 0 ? results : ensemble_.at(k - 1).results; }
 };
 } // namespace JoSIM
 #endif // JOSIM_SIMULATION_HPP
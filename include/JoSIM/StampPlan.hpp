@@ -0,0 +1,110 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_STAMPPLAN_HPP
+#define JOSIM_STAMPPLAN_HPP
+
+#include "JoSIM/AnalysisType.hpp"
+#include "JoSIM/Components.hpp"
+#include "JoSIM/Function.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace JoSIM {
+
+/*
+  Right hand side stamps of the linear devices compiled into sparse matrices.
+
+  The history terms of the companion models are linear in the previous
+  solutions, so they are written as b += H1 x[n-1] + H2 x[n-2] + H3 x[n-3]
+  + H4 x[n-4]. The history matrices H1..H4 are compiled once in CSR form over
+  the rows they touch, and the past solutions are kept in a ring, gathered
+  down to the columns the matrices use. Each step costs one gather and the
+  row sums of four sparse matrix vector products; the devices keep no
+  history of their own while the plan is enabled.
+
+  Source and noise values at the step time are added as separate terms.
+
+  Current sources, resistors, inductors, capacitors, voltage sources, CCVS and
+  VCCS are covered. Phase sources and transmission lines are still stamped
+  by Simulation.
+
+  The stamps can be ordered by the block of a partitioned matrix their rows
+  belong to. begin_step() evaluates every source and noise value in the same
+  order as stamp(), as the noise functions draw from one stream. The stamps
+  of every range of blocks can then be added on their own.
+*/
+
+class StampPlan {
+  private:
+    // Number of past solutions the companion models reach back
+    static constexpr int64_t DEPTH = 4;
+
+    struct SourceTerm {
+        int64_t row;
+        int64_t slot;
+        double  coef;
+    };
+
+    // History matrix in compressed sparse row format over the plan rows and gathered columns
+    struct HistoryMatrix {
+        std::vector<double>  nz;
+        std::vector<int64_t> ci, rp;
+    };
+
+    bool                                       enabled_ = false;
+    // Sum chunks of rows on the OpenMP threads
+    bool                                       parallel_ = false;
+    // Source and noise values of the step
+    std::vector<double>                        values_;
+    // sourcegen entries and device noise evaluated at the step time, as (slot, source) pairs
+    std::vector<std::pair<int64_t, int64_t>>   sources_;
+    std::vector<std::pair<int64_t, Function*>> noise_;
+    std::vector<SourceTerm>                    sourceTerms_;
+    // Rows of b the history matrices add to and the solution entries they read
+    std::vector<int64_t>                       rows_, cols_;
+    std::array<HistoryMatrix, DEPTH>           history_;
+    // Gathered past solutions, x[n-1-k] is at ring_[(head_ + k) % DEPTH]
+    std::array<std::vector<double>, DEPTH>     ring_;
+    int64_t                                    head_ = 0;
+    // First row, column and source term of every block and one past the last, if ordered by block
+    std::vector<int64_t>                       rowStart_, colStart_, termStart_;
+
+    int64_t add_source(int64_t sourceIndex);
+    int64_t add_noise(Function& noise);
+    // Order the stamps by the block of their rows, unless some stamp reads another block
+    void    order_by_block(const std::vector<int64_t>& blockOf);
+    // Add the history terms of the plan rows begin to end - 1 to b
+    void    add_history(int64_t begin, int64_t end, std::vector<double>& b) const;
+
+  public:
+    bool enabled() const { return enabled_; }
+
+    void parallel(bool value) { parallel_ = value; }
+
+    // Compile the stamps of the given components for step size h, which must
+    // outlive the plan. The past solutions start out as zero. With blockOf,
+    // the block of every variable, the stamps are ordered by block.
+    void load(Components& components, AnalysisType atyp, double h, const std::vector<int64_t>& blockOf = {});
+
+    // Number of blocks the stamps are ordered by, 0 if not ordered
+    int64_t blocks() const { return rowStart_.empty() ? 0 : static_cast<int64_t>(rowStart_.size()) - 1; }
+
+    // Forget the compiled stamps, the devices stamp themselves again
+    void clear();
+
+    // Add the stamps of step time t to b, x being the last solution
+    void stamp(const std::vector<double>& x, std::vector<double>& b, std::vector<Function>& sourcegen, double t);
+
+    // Evaluate the sources and noise at step time t and start the step, before the blocks are stamped with
+    // stamp_blocks()
+    void begin_step(std::vector<Function>& sourcegen, double t);
+
+    // Add the stamps of blocks [from, to) to their rows of b, x being the last solution
+    void stamp_blocks(int64_t from, int64_t to, const std::vector<double>& x, std::vector<double>& b);
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_STAMPPLAN_HPP
@@ -0,0 +1,82 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_STREAM_HPP
+#define JOSIM_STREAM_HPP
+
+#include "JoSIM/Input.hpp"
+#include "JoSIM/Matrix.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace JoSIM {
+
+/*
+  Output files written while simulating.
+
+  The traces filtered at the print times while simulating are complete
+  rows of the output files as soon as the half filter window after them
+  has been simulated. The simulation pushes every row into a fixed size
+  single producer single consumer ring, and a writer thread formats the
+  rows it takes from the ring into the files. Formatting overlaps with the
+  simulation and the files are complete right after the last step. The
+  ring only blocks the simulation if the writer falls a whole ring behind.
+  Only CSV and DAT files are streamed, the raw header holds the number of
+  points.
+*/
+
+class Stream {
+  private:
+    struct File {
+        std::string          name;
+        char                 delimiter;
+        // Positions in the row of the columns after time
+        std::vector<int64_t> columns;
+        std::ofstream        out;
+    };
+
+    // Rows held by the ring
+    static constexpr int64_t CAPACITY = 4096;
+
+    bool                     enabled_ = false;
+    std::vector<std::string> names_;
+    std::vector<File>        files_;
+    // Rows of time followed by the filtered traces, by row modulo the capacity
+    int64_t                  width_ = 0;
+    std::vector<double>      ring_;
+    // Rows pushed by the simulation and taken by the writer, never decreasing
+    std::atomic<int64_t>     head_{0}, tail_{0};
+    std::atomic<bool>        closed_{false};
+    std::thread              writer_;
+
+    void                     write();
+
+  public:
+    // Stream the CSV and DAT output files of input iObj if the STREAM option is set and there is no raw output
+    Stream(const Input& iObj, const Matrix& mObj);
+    ~Stream() { finish(); }
+    Stream(const Stream&)            = delete;
+    Stream& operator=(const Stream&) = delete;
+
+    bool    enabled() const { return enabled_; }
+
+    // Whether the files are being written
+    bool    started() const { return writer_.joinable(); }
+
+    // Write the headers and start the writer, restarting the files if they were started before
+    void    start();
+
+    // Add the row of print time t and traces values, waiting while the ring is full
+    void    push(double t, const std::vector<double>& values);
+
+    // Write the remaining rows and close the files
+    void    finish();
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_STREAM_HPP
@@ -0,0 +1,78 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_SWEEP_HPP
+#define JOSIM_SWEEP_HPP
+
+#include "JoSIM/Input.hpp"
+#include "JoSIM/Output.hpp"
+#include "JoSIM/ParameterName.hpp"
+#include "JoSIM/Simulation.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace JoSIM {
+
+/*
+  Sweep of .param values given by .sweep controls.
+
+  Every .sweep control varies one parameter over a range or a list, several
+  controls sweep every combination with the last control varying fastest.
+  The netlist is parsed and expanded once. Every point assigns its values,
+  evaluates the parameters and models again and simulates a copy of the
+  input, sharing the symbolic analysis of the first point as long as the
+  sparsity pattern does not change. Points run on a pool of threads.
+
+  With the LOCKSTEP option every thread takes a batch of consecutive
+  points. Points of a batch whose matrices hold the same nonzeros, such as
+  points that only sweep source amplitudes, are simulated as one ensemble
+  in lockstep, solving their right hand sides together. Transients stepped
+  other than with a fixed step in one piece simulate every point on its own.
+
+  The output concatenates the points, with columns for the sweep index and
+  the swept values.
+*/
+
+class Sweep {
+  private:
+    struct Axis {
+        ParameterName            name;
+        // Expressions of the swept values
+        std::vector<std::string> values;
+    };
+
+    std::vector<Axis>               axes_;
+    int64_t                         points_   = 0;
+    int64_t                         threads_  = 1;
+    // Points simulated in lockstep at most, 1 simulates every point on its own
+    int64_t                         lockstep_ = 1;
+    // Output traces and swept values of every point
+    std::vector<Output>             outputs_;
+    std::vector<std::vector<double>> values_;
+    std::unique_ptr<SharedSymbolic> symbolic_;
+
+    // Parameter expressions of point k
+    std::vector<std::pair<ParameterName, std::string>> point(int64_t k) const;
+    void                                               run_point(const Input& iObj, int64_t k);
+    // Simulate points first to last - 1, those sharing a matrix in lockstep
+    void                                               run_batch(const Input& iObj, int64_t first, int64_t last);
+
+  public:
+    // Read the .sweep controls and the THREADS option
+    Sweep(const Input& iObj);
+
+    bool enabled() const { return points_ > 0; }
+
+    // Simulate every point
+    void run(const Input& iObj);
+
+    // Write the points as one output to the output files of the input, or to the terminal
+    void write_sweep(const Input& iObj) const;
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_SWEEP_HPP
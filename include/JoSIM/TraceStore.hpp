@@ -0,0 +1,94 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef JOSIM_TRACESTORE_HPP
+#define JOSIM_TRACESTORE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace JoSIM {
+
+/*
+  Native columnar trace store.
+
+  A trace store holds every trace as one contiguous column of little endian
+  doubles, so a single trace of a large output is read straight from a
+  memory mapping of the file without touching the others. All integers are
+  little endian and the file is laid out as
+
+    header   64 bytes   magic "JOSIMTRC", version, flags, number of traces,
+                        points per trace and the offsets of the index, the
+                        names and the data
+    index    32 bytes   per trace: offset and length of its name, its type
+                        'T', 'V', 'P', 'I' or 'S', and the offset and length
+                        of its column
+    names               the trace names, not terminated
+    data                the columns, starting on a page boundary with every
+                        column starting on a cache line
+
+  Time is the first trace, of type 'T'.
+*/
+
+class TraceStore {
+  public:
+    static constexpr char     MAGIC[8]       = {'J', 'O', 'S', 'I', 'M', 'T', 'R', 'C'};
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr int64_t  HEADER_SIZE    = 64;
+    static constexpr int64_t  ENTRY_SIZE     = 32;
+    static constexpr int64_t  DATA_ALIGN     = 4096;
+    static constexpr int64_t  COLUMN_ALIGN   = 64;
+
+    struct Entry {
+        std::string name;
+        char        type;
+        // Byte offset of the column in the file and its number of values
+        uint64_t    offset;
+        uint64_t    length;
+    };
+
+  private:
+    std::vector<Entry> index_;
+    uint64_t           points_ = 0;
+    const char*        map_    = nullptr;
+    uint64_t           size_   = 0;
+#ifdef _WIN32
+    void*              file_    = nullptr;
+    void*              mapping_ = nullptr;
+#else
+    int                file_ = -1;
+#endif
+
+    void               close();
+
+  public:
+    // Map the trace store filename and read its index
+    TraceStore(const std::string& filename);
+    ~TraceStore() { close(); }
+    TraceStore(const TraceStore&)            = delete;
+    TraceStore& operator=(const TraceStore&) = delete;
+
+    // Number of traces, including time
+    int64_t                   size() const { return static_cast<int64_t>(index_.size()); }
+
+    uint64_t                  points() const { return points_; }
+
+    const std::vector<Entry>& index() const { return index_; }
+
+    // Position in the index of the trace called name
+    std::optional<int64_t>    find(const std::string& name) const;
+
+    // Values of trace k, mapped from the file
+    const double*             data(int64_t k) const {
+        return reinterpret_cast<const double*>(map_ + index_.at(k).offset);
+    }
+
+    // Write the traces with the given names, types and values, all columns having the same length
+    static void               write(const std::string& filename, const std::vector<std::string>& names,
+                                    const std::vector<char>& types, const std::vector<const std::vector<double>*>& columns);
+};
+
+} // namespace JoSIM
+
+#endif // JOSIM_TRACESTORE_HPP
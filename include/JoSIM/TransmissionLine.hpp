@@ -52,9 +52,15 @@ namespace JoSIM {
 class TransmissionLine : public BasicComponent {
   private:
     int64_t             hDepPos_ = 0;
+    double              td_ = 0.0, h_ = 0.0;
     JoSIM::AnalysisType at_;
 
   public:
+    // Port values and currents of a step
+    struct Sample {
+        double v1 = 0.0, v2 = 0.0, i1 = 0.0, i2 = 0.0;
+    };
+
     NodeConfig nodeConfig2_;
     int_o      posIndex2_, negIndex2_;
     int64_t    currentIndex2_ = 0;
@@ -62,6 +68,10 @@ class TransmissionLine : public BasicComponent {
     double     nk_1_ = 0.0, nk_2_ = 0.0, nk1_1_ = 0.0, nk1_2_ = 0.0, nk2_1_ = 0.0, nk2_2_ = 0.0;
     int64_t    timestepDelay_ = 0;
 
+    // Samples of the last timestepDelay_ + 2 steps read by the delays and two before them, to interpolate the
+    // delayed values onto a smaller step, by step modulo the depth
+    std::vector<Sample> history_;
+
     TransmissionLine(const std::pair<tokens_t, string_o>& s,
                      const NodeConfig&                    ncon,
                      const std::optional<NodeConfig>&     ncon2,
@@ -76,6 +86,14 @@ class TransmissionLine : public BasicComponent {
     void set_secondary_node_indices(const tokens_t& t, const nodemap& nm, nodeconnections& nc);
     void set_secondary_matrix_info();
 
+    // Discard the stored steps, sized for the current delay
+    void reset_history();
+    // Store the solution x of step i
+    void store(int64_t i, const std::vector<double>& x);
+
+    // Sample of step i, one of the last stored steps
+    const Sample& delayed(int64_t i) const { return history_.at(i % history_.size()); }
+
     void update_timestep(const double& factor) override;
 }; // class TransmissionLine
 
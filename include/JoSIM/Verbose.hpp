@@ -5,6 +5,7 @@
 
 #include "JoSIM/Input.hpp"
 #include "JoSIM/Matrix.hpp"
+#include "JoSIM/Simulation.hpp"
 #include "JoSIM/TypeDefines.hpp"
 
 #include <string>
@@ -20,6 +21,10 @@ namespace Verbose {
     void print_parameters(const Input& iObj);
 
     void print_expanded_netlist(const Input& iObj);
+
+    void print_solver_stats(const int64_t& vl, const Simulation& sObj);
+
+    void print_solver_stats(const int64_t& vl, const SolverStats& stats);
 } // namespace Verbose
 
 } // namespace JoSIM
@@ -0,0 +1,68 @@
+#!/usr/bin/env python
+# Import relevant packages
+import os, sys, argparse, shutil, subprocess, tempfile, time
+
+# Count the instructions retired by a single run using perf, None if unavailable
+def count_instructions(cmd):
+  if shutil.which("perf") is None:
+    return None
+  res = subprocess.run(["perf", "stat", "-x", ",", "-e", "instructions:u"] + cmd,
+                       stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+  for line in res.stderr.splitlines():
+    fields = line.split(",")
+    if len(fields) > 2 and fields[2].startswith("instructions"):
+      try:
+        return int(fields[0])
+      except ValueError:
+        return None
+  return None
+
+# Run a simulator binary on the netlist, returning the best wall time and the instruction count
+def measure(sim, netlist, analysis, repeat):
+  with tempfile.TemporaryDirectory() as tmp:
+    cmd = [sim, "-a", str(analysis), "-m", "1", "-o", os.path.join(tmp, "out.csv"), netlist]
+    best = None
+    for _ in range(repeat):
+      start = time.perf_counter()
+      res = subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+      elapsed = time.perf_counter() - start
+      if res.returncode != 0:
+        print("Simulation failed: " + " ".join(cmd))
+        sys.exit(1)
+      best = elapsed if best is None else min(best, elapsed)
+    return best, count_instructions(cmd)
+
+# Main function
+def main():
+  # Version info
+  vers = "JoSIM Bench - 1.0 - Compare the cost of a netlist between two JoSIM builds"
+
+  # Initiate the parser
+  parser = argparse.ArgumentParser(description=vers)
+
+  # Add possible parser arguments
+  parser.add_argument("baseline", help="the baseline josim-cli binary")
+  parser.add_argument("candidate", help="the candidate josim-cli binary")
+  parser.add_argument("-n", "--netlist", help="the netlist to simulate. Default: test/ex_ksa4bit.cir",
+                      default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "test", "ex_ksa4bit.cir"))
+  parser.add_argument("-a", "--analysis", nargs='+', type=int, help="analysis types to run, 0 (voltage) and/or 1 (phase). Default: 0 1", default=[0, 1])
+  parser.add_argument("-r", "--repeat", type=int, help="number of runs per binary, the fastest is reported. Default: 3", default=3)
+  parser.add_argument("-V", "--version", action='version', help="show script version", version=vers)
+
+  # Read arguments from the command line
+  args = parser.parse_args()
+
+  print(vers)
+  print("Netlist: " + args.netlist)
+  for analysis in args.analysis:
+    base_time, base_inst = measure(args.baseline, args.netlist, analysis, args.repeat)
+    cand_time, cand_inst = measure(args.candidate, args.netlist, analysis, args.repeat)
+    print("Analysis type %d:" % analysis)
+    print("  Wall time     %10.3f s %10.3f s   %+6.1f%%" % (base_time, cand_time, 100.0 * (cand_time - base_time) / base_time))
+    if base_inst is not None and cand_inst is not None:
+      print("  Instructions  %12d %12d   %+6.1f%%" % (base_inst, cand_inst, 100.0 * (cand_inst - base_inst) / base_inst))
+    else:
+      print("  Instructions  unavailable, perf could not count instructions:u")
+
+if __name__ == '__main__':
+  main()
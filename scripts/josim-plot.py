@@ -4,6 +4,7 @@ import os, math, sys, argparse
 import plotly.graph_objects as go
 from plotly.subplots import make_subplots
 import pandas as pd
+import numpy as np
 import plotly
 
 # Main function
@@ -36,9 +37,11 @@ def main():
     df = pd.read_csv(args.input, sep=',')
   elif (os.path.splitext(args.input)[1].lower() == ".dat"):
     df = pd.read_csv(args.input, delim_whitespace=True)
+  elif (os.path.splitext(args.input)[1].lower() == ".jts"):
+    df = read_store(args.input)
   else:
     print("Invalid input file specified: " + args.input)
-    print("Please provide either .csv (comma seperated) or .dat (space seperated) file")
+    print("Please provide either .csv (comma seperated), .dat (space seperated) or .jts (trace store) file")
     sys.exit()
 
   # Determine the plot layout.
@@ -111,6 +114,27 @@ def main():
     print("Unknown file format for output file specified.")
     print("Please use: png, jpeg, webp, svg, eps or pdf")  
 
+# Read a JoSIM trace store, every column is mapped from the file rather than parsed
+def read_store(filename):
+  header = np.fromfile(filename, dtype='<u8', count=8)
+  if header[0].tobytes() != b"JOSIMTRC" or (int(header[1]) & 0xffffffff) != 1:
+    print("Invalid trace store: " + filename)
+    sys.exit()
+  count, indexOffset, nameOffset = int(header[2]), int(header[4]), int(header[5])
+  index = np.memmap(filename, mode='r', offset=indexOffset, shape=(count,),
+    dtype=np.dtype([('name', '<u8'), ('size', '<u4'), ('type', 'S1'), ('pad', 'V3'), ('offset', '<u8'), ('length', '<u8')]))
+  raw = np.memmap(filename, mode='r', dtype=np.uint8)
+  columns = {}
+  for e in index:
+    name = raw[nameOffset + int(e['name']):nameOffset + int(e['name']) + int(e['size'])].tobytes().decode()
+    # Repeated names are numbered as read_csv does
+    label, k = name, 0
+    while label in columns:
+      k += 1
+      label = name + "." + str(k)
+    columns[label] = np.memmap(filename, mode='r', dtype='<f8', offset=int(e['offset']), shape=(int(e['length']),))
+  return pd.DataFrame(columns)
+
 # Function that sets the Y-axis title relevant to the data
 def y_axis_title(figLabel):
   if figLabel[0] == 'V':
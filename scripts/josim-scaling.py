@@ -0,0 +1,73 @@
+#!/usr/bin/env python
+# Import relevant packages
+import filecmp, os, subprocess, sys, tempfile, time, argparse
+
+# Write a JTL chain of the given number of stages, every stage biased on its own
+def write_jtl(path, stages, tstop):
+  with open(path, "w") as f:
+    f.write("* Generated JTL chain of %d stages\n" % stages)
+    f.write(".model jmitll jj(rtype=1, vg=2.8mV, cap=0.07pF, r0=160, rN=16, icrit=0.1mA)\n")
+    f.write("VIN in 0 pwl(0 0 5p 0 7.5p 827.13u 10p 0)\n")
+    f.write("LIN in n1 2.031p\n")
+    for k in range(1, stages + 1):
+      f.write("B%d n%d j%d jmitll area=2.16\n" % (k, k, k))
+      f.write("LP%d j%d 0 0.086p\n" % (k, k))
+      f.write("RB%d n%d r%d 5.23\n" % (k, k, k))
+      f.write("LRB%d r%d j%d 0.086p\n" % (k, k, k))
+      f.write("IB%d 0 n%d pwl(0 0 5p 150u)\n" % (k, k))
+      f.write("L%d n%d n%d 4.85p\n" % (k, k, k + 1))
+    f.write("ROUT n%d 0 2\n" % (stages + 1))
+    f.write(".tran 0.25p %s 0 0.25p\n" % tstop)
+    f.write(".print PHASE B1\n")
+    f.write(".print PHASE B%d\n" % stages)
+    f.write(".end\n")
+
+# Run the simulator in parallel mode on the given number of OpenMP threads, returning the wall time
+def run(sim, netlist, output, analysis, threads):
+  env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+  cmd = [sim, "-p", "-a", str(analysis), "-m", "1", "-o", output, netlist]
+  start = time.perf_counter()
+  res = subprocess.run(cmd, env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+  elapsed = time.perf_counter() - start
+  if res.returncode != 0:
+    print("Simulation failed: " + " ".join(cmd))
+    sys.exit(1)
+  return elapsed
+
+# Main function
+def main():
+  # Version info
+  vers = "JoSIM Scaling - 1.0 - Measure the speedup of parallel stamping on a generated JTL chain"
+
+  # Initiate the parser
+  parser = argparse.ArgumentParser(description=vers)
+
+  # Add possible parser arguments
+  parser.add_argument("simulator", help="a josim-cli binary compiled with USING_OPENMP")
+  parser.add_argument("-s", "--stages", type=int, help="number of JTL stages. Default: 100000", default=100000)
+  parser.add_argument("-t", "--threads", nargs='+', type=int, help="OpenMP thread counts to run. Default: 1 2 4 8", default=[1, 2, 4, 8])
+  parser.add_argument("-e", "--tstop", help="transient stop time. Default: 20p", default="20p")
+  parser.add_argument("-a", "--analysis", type=int, help="analysis type, 0 (voltage) or 1 (phase). Default: 1", default=1)
+  parser.add_argument("-V", "--version", action='version', help="show script version", version=vers)
+
+  # Read arguments from the command line
+  args = parser.parse_args()
+
+  print(vers)
+  with tempfile.TemporaryDirectory() as tmp:
+    netlist = os.path.join(tmp, "jtl.cir")
+    write_jtl(netlist, args.stages, args.tstop)
+    print("JTL chain of %d stages, %s" % (args.stages, args.tstop))
+    base = None
+    reference = None
+    for threads in args.threads:
+      output = os.path.join(tmp, "out_%d.csv" % threads)
+      elapsed = run(args.simulator, netlist, output, args.analysis, threads)
+      base = elapsed if base is None else base
+      # Chunks write their own rows, the results must not depend on the thread count
+      same = reference is None or filecmp.cmp(reference, output, shallow=False)
+      reference = output if reference is None else reference
+      print("  %3d threads  %10.3f s  speedup %5.2f  %s" % (threads, elapsed, base / elapsed, "identical" if same else "DIFFERENT"))
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,107 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/Batch.hpp"
+
+#include "JoSIM/Matrix.hpp"
+#include "JoSIM/Model.hpp"
+#include "JoSIM/Parameters.hpp"
+#include "JoSIM/ProgressBar.hpp"
+#include "JoSIM/RelevantTrace.hpp"
+#include "JoSIM/Rng.hpp"
+#include "JoSIM/Simulation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace JoSIM;
+
+int64_t Batch::threads(const Input& iObj, int64_t count) {
+    int64_t threads = std::max(static_cast<int64_t>(std::thread::hardware_concurrency()), static_cast<int64_t>(1));
+    if (auto t = iObj.find_option("THREADS")) {
+        threads = std::max(static_cast<int64_t>(parse_param(t.value(), iObj.parameters)), static_cast<int64_t>(1));
+    }
+    return std::max(std::min(threads, count), static_cast<int64_t>(1));
+}
+
+void Batch::run(int64_t                             count,
+                int64_t                             threads,
+                const std::function<void(int64_t)>& task,
+                const std::string&                  status,
+                bool                                argMin) {
+    ProgressBar bar;
+    if (!argMin) {
+        bar.create_thread();
+        bar.set_bar_width(30);
+        bar.fill_bar_progress_with("O");
+        bar.fill_bar_remainder_with(" ");
+        bar.set_status_text(status);
+        bar.set_total((float) count);
+    }
+    std::atomic<int64_t>            next   = 0;
+    std::atomic<bool>               failed = false;
+    std::vector<std::exception_ptr> errors(count);
+    std::mutex                      progress;
+    int64_t                         done   = 0;
+    auto                            worker = [&]() {
+        for (int64_t k = next++; k < count && !failed; k = next++) {
+            try {
+                task(k);
+            } catch (...) {
+                errors.at(k) = std::current_exception();
+                failed       = true;
+                Rng::use(nullptr);
+            }
+            if (!argMin) {
+                std::lock_guard<std::mutex> lock(progress);
+                bar.update(static_cast<float>(++done));
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int64_t t = 1; t < threads; ++t) { pool.emplace_back(worker); }
+    worker();
+    for (auto& t : pool) { t.join(); }
+    if (!argMin) {
+        bar.complete();
+        std::cout << "\n";
+    }
+    for (const auto& e : errors) {
+        if (e) { std::rethrow_exception(e); }
+    }
+}
+
+void Batch::assign(Input& iObj, const std::vector<std::pair<ParameterName, std::string>>& expressions) {
+    for (const auto& [name, expression] : expressions) { iObj.parameters.at(name).set_expression(expression); }
+    for (auto& p : iObj.parameters) { p.second.reset_value(); }
+    parse_parameters(iObj.parameters);
+    iObj.netlist.models_new.clear();
+    for (const auto& i : iObj.netlist.models) {
+        Model::parse_model(std::make_pair(i.second, i.first.second), iObj.netlist.models_new, iObj.parameters);
+    }
+}
+
+Output Batch::simulate(const Input& iObj, uint64_t index, bool sanityCheck, const SharedSymbolic* symbolic) {
+    // Creating the matrix alters the input, every run starts from its own copy
+    Input  runInp      = iObj;
+    runInp.argMin      = true;
+    runInp.argVerb     = 0;
+    // Runs are already spread over the batch threads
+    runInp.argParallel = false;
+    auto   streams     = Rng::derive(index);
+    auto*  outer       = Rng::use(&streams);
+    Matrix mObj;
+    mObj.create_matrix(runInp);
+    if (sanityCheck) { runInp.netlist.sanity_check(mObj.components); }
+    find_relevant_traces(runInp, mObj);
+    Simulation sObj(runInp, mObj, symbolic);
+    Rng::use(outer);
+    Output oObj;
+    oObj.write_output(runInp, mObj, sObj);
+    return oObj;
+}
@@ -32,6 +32,11 @@ tokens_t CliOptions::argv_to_tokens(const int64_t& argc, const char** argv) {
     return tokens;
 }
 
+bool CliOptions::no_value(char flag) {
+    // Switches that never take a value, a token following them is the input file
+    return std::strchr("bhpv", flag) != nullptr;
+}
+
 vector_pair_t<char_o, string_o> CliOptions::argument_pairs(const tokens_t& tokens) {
     // Variable to store the argument pairs
     vector_pair_t<char_o, string_o> ap;
@@ -54,8 +59,8 @@ vector_pair_t<char_o, string_o> CliOptions::argument_pairs(const tokens_t& token
             if (tempT.size() > 1) { ap.back().second = tempT.at(1); }
             // If the argument pairs aren't empty
             if (ap.size() != 0) {
-                // If the previous switch was alone then this must be the argument
-                if (!ap.back().second) {
+                // If the previous switch was alone and takes a value then this must be the argument
+                if (!ap.back().second && !no_value(ap.back().first.value())) {
                     ap.back().second = tempT.at(0);
                     // If the last pair has a value then this must be file name
                 } else {
@@ -109,6 +114,8 @@ CliOptions CliOptions::parse(int64_t argc, const char** argv) {
                         Errors::cli_errors(CLIErrors::INVALID_ANALYSIS);
                     }
                     break;
+                    // Write raw output files in binary
+                case 'b': out.binary = true; break;
                     // Show help menu
                 case 'h':
                     display_help();
@@ -139,6 +146,7 @@ CliOptions CliOptions::parse(int64_t argc, const char** argv) {
                 case 'p':
 #ifdef _OPENMP
                     std::cout << "Parallelization is ENABLED" << std::endl;
+                    out.parallel = true;
 #else
                     std::cout << "Parallelization is DISABLED" << std::endl;
 #endif
@@ -215,6 +223,13 @@ void CliOptions::display_help() {
     std::cout << std::setw(16) << std::left << "  " << std::setw(3) << std::left << "|"
               << "1 for Phase analysis (Default)." << std::endl;
     std::cout << std::setw(16) << std::left << "  " << std::setw(3) << std::left << "|" << std::endl;
+    // Binary raw output
+    // ---------------------------------------------------------------------------
+    std::cout << std::setw(16) << std::left << "-b" << std::setw(3) << std::left << "|"
+              << "Writes raw output files in the binary raw format." << std::endl;
+    std::cout << std::setw(16) << std::left << "--binary" << std::setw(3) << std::left << "|"
+              << " " << std::endl;
+    std::cout << std::setw(16) << std::left << "  " << std::setw(3) << std::left << "|" << std::endl;
     // Help menu
     // ---------------------------------------------------------------------------
     std::cout << std::setw(16) << std::left << "-h" << std::setw(3) << std::left << "|"
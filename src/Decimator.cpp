@@ -0,0 +1,172 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/Decimator.hpp"
+
+#include "JoSIM/AnalysisType.hpp"
+#include "JoSIM/Constants.hpp"
+#include "JoSIM/RelevantTrace.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace JoSIM;
+
+std::vector<double> Decimator::window(const Transient& tran) {
+    // Hanning function 1 - cos(x) with x in ]0; 2*pi[ over an odd number of taps, or a single tap of 1 which has
+    // no effect if the filter is disabled
+    int64_t halffirsize = static_cast<int64_t>(tran.prfirwindow() <= 0. ? 0 : .5 * tran.prfirwindow() / tran.tstep());
+    int64_t firsize     = halffirsize * 2 + 1;
+    std::vector<double> firwindow;
+    firwindow.reserve(firsize);
+    double firsum = 0.0;
+    for (int64_t k = 0; k < firsize; k++) {
+        double hanning  = 1. - cos(((double) k + 0.5) * (2. * Constants::PI / (double) firsize));
+        firsum         += hanning;
+        firwindow.emplace_back(hanning);
+    }
+    // Normalize to a sum of 1
+    double firscale = 1. / firsum;
+    for (auto& hanning : firwindow) { hanning = firscale * hanning; }
+    return firwindow;
+}
+
+void Decimator::load(const Input& iObj, const Matrix& mObj) {
+    clear();
+    const auto& tran = iObj.transSim;
+    window_          = window(tran);
+    half_            = static_cast<int64_t>(window_.size()) / 2;
+    prstart_         = tran.prstart();
+    prstep_          = tran.prstep();
+    tstep_           = tran.tstep();
+    bool phase       = iObj.argAnal == AnalysisType::Phase;
+    for (const auto& i : mObj.relevantTraces) {
+        Channel c;
+        c.index1      = i.index1.value_or(-1);
+        c.index2      = i.index2.value_or(-1);
+        auto variable = i.variableIndex.value_or(-1);
+        bool junction = i.deviceLabel.value().at(3) == 'B' && variable != -1;
+        if (i.storageType == StorageType::Voltage) {
+            c.kind = phase ? Kind::Derivative : Kind::Difference;
+        } else if (i.storageType == StorageType::Phase) {
+            c.kind = phase ? Kind::Difference : Kind::Integral;
+        } else if (i.deviceLabel.value().at(3) != 'I') {
+            c.kind = Kind::Variable;
+        } else {
+            c.kind   = Kind::Source;
+            c.source = i.sourceIndex.value();
+            if (mObj.sourcegen.at(c.source).is_noise()) {
+                clear();
+                return;
+            }
+        }
+        // Junctions store their voltage in phase mode and their phase in voltage mode
+        if (junction && (c.kind == Kind::Derivative || c.kind == Kind::Integral)) {
+            c.kind   = Kind::Variable;
+            c.index1 = variable;
+        }
+        channels_.emplace_back(c);
+    }
+    // Without relevant traces every node is written
+    if (mObj.relevantTraces.empty()) {
+        for (const auto& i : mObj.nm) {
+            Channel c;
+            c.kind   = Kind::Variable;
+            c.index1 = i.second;
+            channels_.emplace_back(c);
+        }
+    }
+    for (auto& c : channels_) { c.recent.resize(window_.size()); }
+    enabled_ = true;
+}
+
+double Decimator::sample(Channel& c, Matrix& mObj, double t, const std::vector<double>& x) const {
+    if (c.kind == Kind::Variable) { return x.at(c.index1); }
+    if (c.kind == Kind::Source) { return mObj.sourcegen.at(c.source).value(t); }
+    double valin1 = c.index1 != -1 ? x.at(c.index1) : 0;
+    double valin2 = c.index2 != -1 ? x.at(c.index2) : 0;
+    double value;
+    if (c.kind == Kind::Difference) {
+        value = valin1 - valin2;
+    } else if (c.kind == Kind::Derivative) {
+        // The first step stands in for the steps before it
+        double difference = valin1 - valin2;
+        if (count_ == 0) { c.previous1 = c.previous2 = difference; }
+        value       = ((3.0 * Constants::SIGMA) / (2.0 * tstep_))
+                * (difference - (4.0 / 3.0) * c.previous1 + (1.0 / 3.0) * c.previous2);
+        c.previous2 = c.previous1;
+        c.previous1 = difference;
+    } else {
+        value       = ((2.0 * tstep_) / (3.0 * Constants::SIGMA)) * (valin1 - valin2) + (4.0 / 3.0) * (c.previous1)
+                - (1.0 / 3.0) * (c.previous2);
+        c.previous2 = c.previous1;
+        c.previous1 = value;
+    }
+    return value;
+}
+
+void Decimator::filter(int64_t center, double t) {
+    auto size = static_cast<int64_t>(window_.size());
+    row_.resize(channels_.size());
+    for (int64_t i = 0; i < channels_.size(); ++i) {
+        const auto& c           = channels_.at(i);
+        double      accumulator = 0.;
+        for (int64_t k = 0; k < size; k++) {
+            int64_t jk  = std::clamp(center + half_ - k, static_cast<int64_t>(0), count_ - 1);
+            accumulator += window_.at(k) * (jk == 0 ? c.first : c.recent.at(jk % size));
+        }
+        row_.at(i) = accumulator;
+    }
+    if (sink_) {
+        sink_(t, row_);
+        return;
+    }
+    times_.emplace_back(t);
+    for (int64_t i = 0; i < channels_.size(); ++i) { channels_.at(i).data.emplace_back(row_.at(i)); }
+}
+
+void Decimator::push(Matrix& mObj, double t, const std::vector<double>& x) {
+    auto size = static_cast<int64_t>(window_.size());
+    for (auto& c : channels_) {
+        double value               = sample(c, mObj, t, x);
+        c.recent.at(count_ % size) = value;
+        if (count_ == 0) { c.first = value; }
+    }
+    if (count_ == 0) { start_ = t; }
+    // The first print step is the first at or after the print start, the rest follow on the print grid
+    if (!started_ && t >= prstart_) {
+        started_ = true;
+        next_    = std::max(prstart_, start_) + prstep_;
+        pending_.push_back({count_, t});
+    }
+    if (started_ && t >= next_) {
+        pending_.push_back({count_, t});
+        next_ += prstep_;
+    }
+    ++count_;
+    while (!pending_.empty() && pending_.front().step + half_ < count_) {
+        filter(pending_.front().step, pending_.front().time);
+        pending_.pop_front();
+    }
+}
+
+void Decimator::finish(std::vector<double>& times, std::vector<std::vector<double>>& traces) {
+    while (!pending_.empty()) {
+        filter(pending_.front().step, pending_.front().time);
+        pending_.pop_front();
+    }
+    times = std::move(times_);
+    traces.clear();
+    for (auto& c : channels_) { traces.emplace_back(std::move(c.data)); }
+    clear();
+}
+
+void Decimator::clear() {
+    enabled_ = false;
+    channels_.clear();
+    pending_.clear();
+    times_.clear();
+    sink_    = nullptr;
+    count_   = 0;
+    started_ = false;
+}
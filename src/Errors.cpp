@@ -343,6 +343,57 @@ void Errors::control_errors(ControlErrors errorCode, string_o message) {
             formattedMessage += "Cannot find device or cannot store current of a node.";
             warning_message(formattedMessage);
             break;
+        case ControlErrors::ADAPTIVE_WITH_TX:
+            formattedMessage += "Adaptive time steps are not supported with transmission lines.\n";
+            formattedMessage += "The fixed transient step will be used.";
+            warning_message(formattedMessage);
+            break;
+        case ControlErrors::ENSEMBLE_FIXED_STEP:
+            formattedMessage += "Adaptive time steps and checkpoints are not supported in ensemble mode.\n";
+            formattedMessage += "The fixed transient step will be used, restarting at t=0 if it is halved.";
+            warning_message(formattedMessage);
+            break;
+        case ControlErrors::ANALYSIS_PARAM_NOT_FOUND:
+            formattedMessage += "The parameter " + message.value_or("") + " requested for analysis was not found.\n";
+            formattedMessage += "Please ensure the parameter is declared in the main design.";
+            throw std::runtime_error(formattedMessage);
+        case ControlErrors::MARGIN_NO_PHASE:
+            formattedMessage += "Margin analysis without .pass controls compares the phase of junctions to the "
+                                "nominal run.\n";
+            formattedMessage += "Please store the phase of at least one junction or name the traces to check with "
+                                ".pass.";
+            throw std::runtime_error(formattedMessage);
+        case ControlErrors::INVALID_PASS:
+            formattedMessage += "Invalid pass criterion found.\n";
+            formattedMessage += "Line: " + message.value_or("") + "\n";
+            formattedMessage += "Please name at least one trace and give at most one of a tolerance and a switch count.";
+            throw std::runtime_error(formattedMessage);
+        case ControlErrors::PASS_TRACE_NOT_FOUND:
+            formattedMessage += "The trace " + message.value_or("") + " named by .pass is not stored.\n";
+            formattedMessage += "Please store it with a .print control.";
+            throw std::runtime_error(formattedMessage);
+        case ControlErrors::INVALID_SWEEP:
+            formattedMessage += "Invalid parameter sweep found.\n";
+            formattedMessage += message.value_or("") + "\n";
+            formattedMessage += "Please refer to the manual for proper syntax.";
+            throw std::runtime_error(formattedMessage);
+        case ControlErrors::PARAREAL_UNSUPPORTED:
+            formattedMessage += "Parareal transients do not support " + message.value_or("this circuit") + ".\n";
+            formattedMessage += "The transient will be simulated serially.";
+            warning_message(formattedMessage);
+            break;
+        case ControlErrors::PSS_UNSUPPORTED:
+            formattedMessage += "Periodic steady state analysis does not support " + message.value_or("this circuit")
+                              + ".\n";
+            formattedMessage += "The full transient will be simulated instead.";
+            warning_message(formattedMessage);
+            break;
+        case ControlErrors::PSS_NOT_CONVERGED:
+            formattedMessage += "The periodic steady state did not converge within " + message.value_or("the")
+                              + " periods.\n";
+            formattedMessage += "The last period simulated will be written.";
+            warning_message(formattedMessage);
+            break;
         case ControlErrors::UNKNOWN_NODE:
             formattedMessage += "Node " + message.value_or("") + " was not found in the circuit.\n";
             formattedMessage += "This request for store will be ignored.";
@@ -730,6 +781,14 @@ void Errors::output_errors(OutputErrors errorCode, string_o message) {
             formattedMessage += "Cannot create empty RAW file.";
             warning_message(formattedMessage);
             break;
+        case OutputErrors::CANNOT_READ_STORE:
+            formattedMessage += "Cannot open the requested trace store.\n";
+            formattedMessage += "Please ensure the file exists and can be read: " + message.value_or("");
+            throw std::runtime_error(formattedMessage);
+        case OutputErrors::INVALID_STORE:
+            formattedMessage += "The file is not a valid JoSIM trace store.\n";
+            formattedMessage += "Please ensure it was written by this version of JoSIM: " + message.value_or("");
+            throw std::runtime_error(formattedMessage);
     }
 }
 
@@ -0,0 +1,43 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef SLU
+#    include "JoSIM/FactorCache.hpp"
+
+using namespace JoSIM;
+
+klu_l_numeric* FactorCache::find(const std::string& key) {
+    auto it = lookup_.find(key);
+    if (it == lookup_.end()) { return nullptr; }
+    // Mark as most recently used
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->numeric;
+}
+
+void FactorCache::insert(const std::string& key, klu_l_numeric* numeric, size_t bytes, klu_l_common* common) {
+    // Replace any stale factorization for the same signature
+    auto it = lookup_.find(key);
+    if (it != lookup_.end()) {
+        if (it->second->numeric != numeric) { klu_l_free_numeric(&it->second->numeric, common); }
+        bytes_ -= it->second->bytes;
+        entries_.erase(it->second);
+    }
+    entries_.push_front({key, numeric, bytes});
+    lookup_[key] = entries_.begin();
+    bytes_ += bytes;
+    // Evict least recently used, always keeping the newest entry
+    while (bytes_ > capacity_ && entries_.size() > 1) {
+        auto& last = entries_.back();
+        bytes_ -= last.bytes;
+        klu_l_free_numeric(&last.numeric, common);
+        lookup_.erase(last.key);
+        entries_.pop_back();
+    }
+}
+
+void FactorCache::clear(klu_l_common* common) {
+    for (auto& i : entries_) { klu_l_free_numeric(&i.numeric, common); }
+    entries_.clear();
+    lookup_.clear();
+    bytes_ = 0;
+}
+#endif // SLU
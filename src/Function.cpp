@@ -434,6 +434,11 @@ double Function::return_noise(double& x) {
     }
 }
 
+void Function::redraw_noise() {
+    if (fType_ != FunctionType::NOISE) { return; }
+    miscValues_.at(1) = ampValues_.at(0) * Misc::grand() / sqrt(2.0 * timeValues_.back());
+}
+
 double Function::return_pws(double& x) {
     if (timeValues_.empty() || ampValues_.empty()) { return 0.0; }
 
@@ -503,3 +508,5 @@ double Function::value(double x) {
 }
 
 void Function::ampValues(std::vector<double> values) { ampValues_ = values; }
+
+void Function::timeValues(std::vector<double> values) { timeValues_ = values; }
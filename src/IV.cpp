@@ -3,20 +3,41 @@
 
 #include "JoSIM/IV.hpp"
 
+#include "JoSIM/Batch.hpp"
 #include "JoSIM/Errors.hpp"
 #include "JoSIM/Misc.hpp"
 #include "JoSIM/Parameters.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 
 using namespace JoSIM;
 
-IV::IV(const Input iObj) {
-    for (auto i : iObj.controls) {
+IV::IV(const Input& iObj) {
+    for (const auto& i : iObj.controls) {
         if (i.front() == "IV" || i.front() == ".IV") { setup_iv(i, iObj); }
     }
+    if (curves_.empty()) { return; }
+    // The branches of every curve are independent
+    int64_t tasks = 2 * curves_.size();
+    Batch::run(
+            tasks,
+            Batch::threads(iObj, tasks),
+            [&](int64_t k) {
+                auto& curve          = curves_.at(k / 2);
+                curve.data.at(k % 2) = trace_branch(curve.input, curve.bias.at(k % 2));
+            },
+            "Tracing IV curves",
+            iObj.argMin);
+    for (auto& curve : curves_) {
+        auto iv_data = curve.data.at(0);
+        iv_data.insert(iv_data.end(), curve.data.at(1).begin(), curve.data.at(1).end());
+        write_iv(iv_data, curve.path);
+    }
+    curves_.clear();
 }
 
 void IV::setup_iv(const tokens_t& i, const Input& iObj) {
@@ -36,72 +57,85 @@ void IV::setup_iv(const tokens_t& i, const Input& iObj) {
     Input  ivInp = iObj;
     ivInp.controls.clear();
     tokens_t jj              = {"B01", "1", "0", model, "AREA=1"};
-    tokens_t ib              = {"IB01", "0", "1", "PWL(0", "0", "10P", "0", "50P", "2.5U)"};
+    tokens_t ib              = {"IB01", "0", "1", "PWL(0", "0)"};
     ivInp.netlist.expNetlist = {std::make_pair(jj, subc), std::make_pair(ib, std::nullopt)};
     ivInp.transSim.tstep(0.05E-12);
-    ivInp.transSim.tstop(500E-12);
     ivInp.argAnal = JoSIM::AnalysisType::Voltage;
     ivInp.argMin  = true;
-    std::vector<std::pair<double, double>> iv_data;
-    iv_data   = generate_iv(maxC, ivInp);
+    ivInp.argVerb = 0;
+    // Up to the maximum current and back to rest, then down to the negative maximum and back
+    std::array<std::vector<double>, 2> bias;
+    double                             currentCurr = 0.0;
+    while (currentCurr <= maxC) { bias.at(0).emplace_back(currentCurr += CURRENT_STEP); }
+    while (currentCurr >= 0) { bias.at(0).emplace_back(currentCurr -= CURRENT_STEP); }
+    while (currentCurr >= -maxC) { bias.at(1).emplace_back(currentCurr -= CURRENT_STEP); }
+    while (currentCurr <= 0) { bias.at(1).emplace_back(currentCurr += CURRENT_STEP); }
+    // Every point ends within its longest dwell
+    ivInp.transSim.tstop((std::max(bias.at(0).size(), bias.at(1).size()) + 1) * MAX_DWELL);
     // Sanity check, if parent path of output file is empty then change path to
     // input file path, otherwise file is written in executable location
     auto path = std::filesystem::path(i.at(3));
     if (!path.has_parent_path() && iObj.fileParentPath) {
         path = std::filesystem::path(iObj.fileParentPath.value()).append(i.at(3));
     }
-    write_iv(iv_data, path.string());
+    curves_.push_back({path.string(), ivInp, bias, {}});
 }
 
-std::vector<std::pair<double, double>> IV::generate_iv(double maxC, Input ivInp) {
+std::vector<std::pair<double, double>> IV::trace_branch(const Input& ivInp, const std::vector<double>& bias) {
     std::vector<std::pair<double, double>> iv_data;
-    double                                 currentIncrement = 25E-7;
-    double                                 currentCurr      = 0.0;
-    Matrix                                 ivMat;
-    ivMat.create_matrix(ivInp);
-    while (currentCurr <= maxC) {
-        // Create a matrix object using the input object
-        currentCurr += currentIncrement;
-        ivMat.sourcegen.back().ampValues({0, 0, currentCurr});
-        iv_data.emplace_back(do_simulate(ivInp, ivMat));
-        ivInp.transSim.tstep(0.05E-12);
-    }
-    while (currentCurr >= 0) {
-        // Create a matrix object using the input object
-        currentCurr -= currentIncrement;
-        ivMat.sourcegen.back().ampValues({0, maxC, currentCurr});
-        iv_data.emplace_back(do_simulate(ivInp, ivMat));
-        ivInp.transSim.tstep(0.05E-12);
-    }
-    while (currentCurr >= -maxC) {
-        // Create a matrix object using the input object
-        currentCurr -= currentIncrement;
-        ivMat.sourcegen.back().ampValues({0, 0, currentCurr});
-        iv_data.emplace_back(do_simulate(ivInp, ivMat));
-        ivInp.transSim.tstep(0.05E-12);
-    }
-    while (currentCurr <= 0) {
-        // Create a matrix object using the input object
-        currentCurr += currentIncrement;
-        ivMat.sourcegen.back().ampValues({0, -maxC, currentCurr});
-        iv_data.emplace_back(do_simulate(ivInp, ivMat));
-        ivInp.transSim.tstep(0.05E-12);
-    }
+    if (bias.empty()) { return iv_data; }
+    // Creating the matrix alters the input
+    Input  branchInp = ivInp;
+    Matrix ivMat;
+    ivMat.create_matrix(branchInp);
+    auto&   source   = ivMat.sourcegen.back();
+    // The junction current is the last unknown
+    auto    current  = ivMat.branchIndex - 1;
+    // Point being measured, when its ramp started and the voltage averages of its last windows
+    int64_t point    = 0;
+    double  start    = 0.0, lastTime = 0.0, window = 0.0, previous = 0.0, sum = 0.0;
+    int64_t windows  = 0;
+    // Ramp from the current bias to the next point
+    auto    ramp_to  = [&](double from, double to, double time) {
+        source.timeValues({0.0, time, time + RAMP_TIME});
+        source.ampValues({from, from, to});
+        start   = time;
+        window  = time + RAMP_TIME + SETTLE_TIME;
+        sum     = 0.0;
+        windows = 0;
+    };
+    ramp_to(0.0, bias.front(), 0.0);
+    auto monitor = [&](double time, const std::vector<double>& x) {
+        if (time == 0.0) {
+            // The transient started over with a smaller step
+            iv_data.clear();
+            point = 0;
+            ramp_to(0.0, bias.front(), 0.0);
+        } else if (time > window) {
+            sum += x.front() * (time - lastTime);
+        }
+        lastTime = time;
+        if (time < window + WINDOW_TIME) { return true; }
+        double average = sum / (time - window);
+        bool   steady  = windows > 0 && std::abs(average - previous) <= std::max(REL_TOL * std::abs(average), ABS_TOL);
+        if (!steady && time - start < MAX_DWELL) {
+            // Start the next window
+            previous = average;
+            ++windows;
+            window = time;
+            sum    = 0.0;
+            return true;
+        }
+        // Report the average of the last two windows and move on to the next point
+        iv_data.emplace_back(windows > 0 ? 0.5 * (average + previous) : average, x.at(current));
+        if (++point == bias.size()) { return false; }
+        ramp_to(bias.at(point - 1), bias.at(point), time);
+        return true;
+    };
+    Simulation ivSim(branchInp, ivMat, nullptr, monitor);
     return iv_data;
 }
 
-std::pair<double, double> IV::do_simulate(Input& ivInp, Matrix& ivMat) {
-    // Simulate the iv curve
-    Simulation ivSim(ivInp, ivMat);
-    // Add the results to the stack
-    double&    current  = ivSim.results.xVector.back().value().back();
-    auto&      voltVect = ivSim.results.xVector.front().value();
-    double     voltage  = 0;
-    for (auto i = voltVect.size() / 2; i < voltVect.size(); ++i) { voltage += voltVect.at(i); }
-    voltage = voltage / (voltVect.size() / 2);
-    return std::make_pair(voltage, current);
-}
-
 void IV::write_iv(std::vector<std::pair<double, double>>& iv_data, const std::string& output_path) {
     auto          path = std::filesystem::path(output_path);
     std::ofstream outfile(path.string());
@@ -71,6 +71,7 @@ Inductor::Inductor(const std::pair<tokens_t, string_o>& s,
         // If phase mdoe analysis then append -(L/σ)
         matrixInfo.nonZeros_.emplace_back(-netlistInfo.value_ / Constants::SIGMA);
     }
+    hDepPos_ = matrixInfo.nonZeros_.size() - 1;
 }
 
 void Inductor::add_mutualInductance(const double& m, const AnalysisType& at, const double& h, const int64_t& ci) {
@@ -90,5 +91,10 @@ void Inductor::add_mutualInductance(const double& m, const AnalysisType& at, con
 
 // Update timestep based on a scalar factor i.e 0.5 for half the timestep
 void Inductor::update_timestep(const double& factor) {
-    if (at_ == AnalysisType::Voltage) { matrixInfo.nonZeros_.back() = (1.0 / factor) * matrixInfo.nonZeros_.back(); }
+    if (at_ == AnalysisType::Voltage) {
+        // Self inductance followed by any mutual inductances, all -(3/2) * (L/h)
+        for (auto i = hDepPos_; i < matrixInfo.nonZeros_.size(); ++i) {
+            matrixInfo.nonZeros_.at(i) = (1.0 / factor) * matrixInfo.nonZeros_.at(i);
+        }
+    }
 }
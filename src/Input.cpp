@@ -267,8 +267,9 @@ void Input::parse_input(string_o fileName) {
 
 void Input::syntax_check_controls(std::vector<tokens_t>& controls) {
     // This will simply check controls, complaining if any are not allowed
-    std::vector<std::string> v
-            = {"PRINT", "TRAN", "SAVE", "PLOT", "END", "TEMP", "NEB", "SPREAD", "FILE", "IV", "OPTION"};
+    std::vector<std::string> v = {
+            "PRINT", "TRAN", "SAVE", "PLOT", "END", "TEMP", "NEB", "SPREAD", "FILE", "IV", "OPTION", "MARGIN", "SWEEP",
+            "PASS"};
     for (auto i : controls) {
         if (std::find(v.begin(), v.end(), i.at(0)) == v.end()) {
             Errors::input_errors(InputErrors::UNKNOWN_CONTROL, i.at(0));
@@ -276,6 +277,19 @@ void Input::syntax_check_controls(std::vector<tokens_t>& controls) {
     }
 }
 
+string_o Input::find_option(const std::string& name) const {
+    for (const auto& c : controls) {
+        if (c.empty() || c.front() != "OPTION") { continue; }
+        for (size_t k = 1; k < c.size(); ++k) {
+            // NAME=VALUE
+            if (c.at(k).rfind(name + "=", 0) == 0) { return c.at(k).substr(name.size() + 1); }
+            // NAME VALUE
+            if (c.at(k) == name && (k + 1) < c.size()) { return c.at(k + 1); }
+        }
+    }
+    return std::nullopt;
+}
+
 std::optional<uint64_t> Input::find_seed_option() const {
     for (const auto& c : controls) {
         if (c.empty()) { continue; }
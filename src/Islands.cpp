@@ -0,0 +1,169 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/Islands.hpp"
+
+#include "JoSIM/Batch.hpp"
+#include "JoSIM/Parameters.hpp"
+#include "JoSIM/RelevantTrace.hpp"
+#include "JoSIM/Rng.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+
+using namespace JoSIM;
+
+Islands::Islands(const Input& iObj, const Matrix& mObj) {
+    if (auto is = iObj.find_option("ISLANDS")) {
+        if (parse_param(is.value(), iObj.parameters) == 0) { return; }
+    }
+    // Every ensemble instance writes its own output
+    if (auto en = iObj.find_option("ENSEMBLE")) {
+        if (parse_param(en.value(), iObj.parameters) > 1) { return; }
+    }
+    // Creating the matrix rewinds the streams, any draw since then was a spread or noise value
+    auto fresh = Rng::derive(0);
+    if (fresh.noise != Rng::noise() || fresh.spread != Rng::spread()) { return; }
+    const auto&          lines = iObj.netlist.expNetlist;
+    // Union of the lines sharing a node
+    std::vector<int64_t> parent(lines.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&](int64_t k) {
+        while (parent.at(k) != k) {
+            parent.at(k) = parent.at(parent.at(k));
+            k            = parent.at(k);
+        }
+        return k;
+    };
+    std::unordered_map<std::string, int64_t> nodeLine, labelLine;
+    for (int64_t k = 0; k < lines.size(); ++k) {
+        const auto& t = lines.at(k).first;
+        labelLine.emplace(t.front(), k);
+        // Mutual inductances name inductors instead of nodes
+        if (t.front().at(0) == 'K') { continue; }
+        int64_t nodes = std::string("EFGHT").find(t.front().at(0)) != std::string::npos ? 4 : 2;
+        for (int64_t n = 1; n <= nodes && n < t.size(); ++n) {
+            if (t.at(n).find("GND") != std::string::npos || t.at(n) == "0") { continue; }
+            auto [it, added] = nodeLine.emplace(t.at(n), k);
+            if (!added) { parent.at(root(k)) = root(it->second); }
+        }
+    }
+    for (int64_t k = 0; k < lines.size(); ++k) {
+        const auto& t = lines.at(k).first;
+        if (t.front().at(0) != 'K') { continue; }
+        for (int64_t n = 1; n <= 2 && n < t.size(); ++n) {
+            if (labelLine.count(t.at(n)) != 0) { parent.at(root(k)) = root(labelLine.at(t.at(n))); }
+        }
+    }
+    // Number the islands in order of their first line
+    std::vector<int64_t> number(lines.size(), -1), lineIsland(lines.size());
+    for (int64_t k = 0; k < lines.size(); ++k) {
+        auto r = root(k);
+        if (number.at(r) == -1) {
+            number.at(r) = lines_.size();
+            lines_.emplace_back();
+        }
+        lineIsland.at(k) = number.at(r);
+        lines_.at(number.at(r)).emplace_back(k);
+    }
+    if (!enabled()) { return; }
+    owner_.assign(mObj.branchIndex, -1);
+    local_.assign(mObj.branchIndex, -1);
+    for (const auto& [name, index] : mObj.nm) { owner_.at(index) = lineIsland.at(nodeLine.at(name)); }
+    // Devices are created in netlist order, each with a row and a variable for every one of its branches.
+    // Current sources and mutual inductances add no device.
+    int64_t device = 0, variable = mObj.nm.size();
+    for (int64_t k = 0; k < lines.size(); ++k) {
+        auto c = lines.at(k).first.front().at(0);
+        if (c == 'I' || c == 'K') { continue; }
+        auto rows = std::visit([](const auto& d) { return d.matrixInfo.rowPointer_.size(); },
+                               mObj.components.devices.at(device++));
+        for (size_t r = 0; r < rows; ++r) { owner_.at(variable++) = lineIsland.at(k); }
+    }
+    threads_ = Batch::threads(iObj, lines_.size());
+}
+
+void Islands::run_island(const Input& iObj, const Input& base, const Matrix& mObj, int64_t k, double tstep) {
+    Input islandInp  = base;
+    islandInp.argMin = true;
+    islandInp.transSim.tstep(tstep);
+    for (auto l : lines_.at(k)) { islandInp.netlist.expNetlist.emplace_back(iObj.netlist.expNetlist.at(l)); }
+    auto   streams = Rng::derive(0);
+    auto*  outer   = Rng::use(&streams);
+    Matrix island;
+    island.create_matrix(islandInp);
+    // Nodes keep their names, branches their order
+    for (const auto& [name, index] : island.nm) { local_.at(mObj.nm.at(name)) = index; }
+    int64_t variable = island.nm.size();
+    for (int64_t g = mObj.nm.size(); g < mObj.branchIndex; ++g) {
+        if (owner_.at(g) == k) { local_.at(g) = variable++; }
+    }
+    // Store what the traces of the whole circuit need from the island
+    for (const auto& trace : mObj.relevantTraces) {
+        auto localTrace = trace;
+        bool inside     = false;
+        localTrace.sourceIndex.reset();
+        for (auto* index : {&localTrace.index1, &localTrace.index2, &localTrace.variableIndex}) {
+            if (*index && owner_.at(index->value()) == k) {
+                *index = local_.at(index->value());
+                inside = true;
+            } else {
+                index->reset();
+            }
+        }
+        if (inside) { island.relevantTraces.emplace_back(localTrace); }
+    }
+    find_relevant_indices(island);
+    Simulation sObj(islandInp, island);
+    Rng::use(outer);
+    results_.at(k) = std::move(sObj.results);
+    stats_.at(k).add(sObj.stats);
+    steps_.at(k) = islandInp.transSim.tstep();
+}
+
+Results Islands::run(Input& iObj, const Matrix& mObj) {
+    // Islands copy everything but the lines of the netlist
+    Input base   = iObj;
+    base.argVerb = 0;
+    base.netlist.expNetlist.clear();
+    // Island results are scattered step by step, every step is stored
+    base.controls.insert(base.controls.begin(), {"OPTION", "DECIMATE=0"});
+    results_.assign(size(), Results());
+    stats_.assign(size(), SolverStats());
+    steps_.assign(size(), iObj.transSim.tstep());
+    std::vector<int64_t> pending(size());
+    std::iota(pending.begin(), pending.end(), 0);
+    // Islands halve their steps on their own, any left with a larger step is simulated again with the smallest
+    double tstep = iObj.transSim.tstep();
+    while (!pending.empty()) {
+        Batch::run(
+                pending.size(),
+                threads_,
+                [&](int64_t p) { run_island(iObj, base, mObj, pending.at(p), tstep); },
+                "Simulating circuit islands",
+                iObj.argMin);
+        tstep = *std::min_element(steps_.begin(), steps_.end());
+        pending.clear();
+        for (int64_t k = 0; k < size(); ++k) {
+            if (steps_.at(k) > tstep) { pending.emplace_back(k); }
+        }
+    }
+    iObj.transSim.tstep(tstep);
+    // Scatter the island results to the variables of the whole circuit
+    Results results;
+    results.timeAxis = std::move(results_.front().timeAxis);
+    results.xVector.resize(mObj.branchIndex);
+    for (int64_t g = 0; g < mObj.branchIndex; ++g) {
+        results.xVector.at(g) = std::move(results_.at(owner_.at(g)).xVector.at(local_.at(g)));
+    }
+    results_.clear();
+    return results;
+}
+
+SolverStats Islands::stats() const {
+    SolverStats total;
+    for (const auto& s : stats_) { total.add(s); }
+    return total;
+}
@@ -112,6 +112,24 @@ JJ::JJ(const std::pair<tokens_t, string_o>& s,
     }
 }
 
+void JJ::update_timestep(const double& factor) {
+    h_ = factor * h_;
+    if (at_ == AnalysisType::Voltage) {
+        phaseConst_ = (3 * Constants::HBAR) / (4 * h_ * Constants::EV);
+    } else if (at_ == AnalysisType::Phase) {
+        phaseConst_ = (4 * h_ * Constants::EV) / (3 * Constants::HBAR);
+    }
+    matrixInfo.nonZeros_.at(hDepPos_) = -phaseConst_;
+    // The conductance of the current state also depends on h
+    if (state_ == 0) {
+        matrixInfo.nonZeros_.back() = -1 / subgap_impedance();
+    } else if (state_ == 1) {
+        matrixInfo.nonZeros_.back() = -1 / transient_impedance();
+    } else {
+        matrixInfo.nonZeros_.back() = -1 / normal_impedance();
+    }
+}
+
 double JJ::subgap_impedance() {
     // Set subgap impedance (1/R0) + (3C/2h)
     return ((1 / model_.r0()) + ((3.0 * model_.c()) / (2.0 * h_)));
@@ -0,0 +1,288 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/JJBlock.hpp"
+
+#include "JoSIM/Constants.hpp"
+#include "JoSIM/Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+
+using namespace JoSIM;
+
+namespace {
+// The entries of an ascending list of junctions that lie in [first, last)
+struct Span {
+    const int64_t* first;
+    const int64_t* last;
+
+    const int64_t* begin() const { return first; }
+    const int64_t* end() const { return last; }
+};
+
+Span within(const std::vector<int64_t>& list, int64_t first, int64_t last) {
+    auto b = std::lower_bound(list.begin(), list.end(), first);
+    auto e = std::lower_bound(b, list.end(), last);
+    return {list.data() + (b - list.begin()), list.data() + (e - list.begin())};
+}
+} // namespace
+
+void JJBlock::load(Components& components, AnalysisType atyp, const std::vector<int64_t>& blockOf) {
+    atyp_ = atyp;
+    devices_.clear();
+    for (const auto& j : components.junctionIndices) { devices_.emplace_back(&std::get<JJ>(components.devices.at(j))); }
+    // Keep the junctions of a block together, in netlist order
+    blockStart_.clear();
+    auto                 n = devices_.size();
+    // Netlist position of every packed junction
+    std::vector<int64_t> netlist(n);
+    std::iota(netlist.begin(), netlist.end(), 0);
+    if (!blockOf.empty()) {
+        auto block = [&](const JJ* d) { return blockOf.at(d->variableIndex_); };
+        std::stable_sort(netlist.begin(), netlist.end(), [&](int64_t a, int64_t b) {
+            return block(devices_.at(a)) < block(devices_.at(b));
+        });
+        std::vector<JJ*> packed;
+        for (auto k : netlist) { packed.emplace_back(devices_.at(k)); }
+        devices_       = std::move(packed);
+        int64_t blocks = *std::max_element(blockOf.begin(), blockOf.end()) + 1;
+        blockStart_.assign(blocks + 1, 0);
+        for (const auto* d : devices_) { ++blockStart_.at(block(d) + 1); }
+        for (int64_t k = 0; k < blocks; ++k) { blockStart_.at(k + 1) += blockStart_.at(k); }
+    }
+    harmonics_ = 0;
+    for (const auto& d : devices_) { harmonics_ = std::max(harmonics_, static_cast<int64_t>(d->model_.cpr().size())); }
+    for (auto* a : {&pos, &neg, &variable, &current}) { a->resize(n); }
+    for (auto* a : {&p1, &p2, &p3, &p4, &v1, &v2, &v3, &v4, &v5, &v6, &v0, &phi0, &ic, &c, &phiOff, &it, &g, &sinPhi}) {
+        a->resize(n);
+    }
+    sinK_.resize(n);
+    sinKm1_.resize(n);
+    twoCos_.resize(n);
+    cpr.assign(harmonics_ * n, 0.0);
+    posGnd_.clear();
+    gndNeg_.clear();
+    posNeg_.clear();
+    gndGnd_.clear();
+    tDep_.clear();
+    switching_.clear();
+    noisy_.clear();
+    for (int64_t j = 0; j < n; ++j) {
+        auto& d        = *devices_.at(j);
+        pos.at(j)      = d.indexInfo.posIndex_.value_or(-1);
+        neg.at(j)      = d.indexInfo.negIndex_.value_or(-1);
+        variable.at(j) = d.variableIndex_;
+        current.at(j)  = d.indexInfo.currentIndex_.value();
+        p1.at(j)       = d.pn1_;
+        p2.at(j)       = d.pn2_;
+        p3.at(j)       = d.pn3_;
+        p4.at(j)       = d.pn4_;
+        phi0.at(j)     = d.phi0_;
+        v1.at(j)       = d.vn1_;
+        v2.at(j)       = d.vn2_;
+        v3.at(j)       = d.vn3_;
+        v4.at(j)       = d.vn4_;
+        v5.at(j)       = d.vn5_;
+        v6.at(j)       = d.vn6_;
+        ic.at(j)       = d.model_.ic();
+        c.at(j)        = d.model_.c();
+        phiOff.at(j)   = d.model_.phiOff();
+        it.at(j)       = d.it_;
+        g.at(j)        = d.matrixInfo.nonZeros_.back();
+        const auto& coefficients = d.model_.cpr();
+        for (int64_t k = 0; k < coefficients.size(); ++k) { cpr.at(k * n + j) = coefficients.at(k); }
+        if (pos.at(j) >= 0 && neg.at(j) < 0) {
+            posGnd_.emplace_back(j);
+        } else if (pos.at(j) < 0 && neg.at(j) >= 0) {
+            gndNeg_.emplace_back(j);
+        } else if (pos.at(j) >= 0 && neg.at(j) >= 0) {
+            posNeg_.emplace_back(j);
+        } else {
+            gndGnd_.emplace_back(j);
+        }
+        if (d.model_.tDep()) { tDep_.emplace_back(j); }
+        if (d.model_.rtype() == 1) { switching_.emplace_back(j); }
+        if (d.thermalNoise) { noisy_.emplace_back(j); }
+    }
+    noiseOrder_ = noisy_;
+    std::sort(noiseOrder_.begin(), noiseOrder_.end(), [&](int64_t a, int64_t b) {
+        return netlist.at(a) < netlist.at(b);
+    });
+    noise_.assign(n, 0.0);
+}
+
+void JJBlock::refresh() {
+    for (int64_t j = 0; j < size(); ++j) { g[j] = devices_[j]->matrixInfo.nonZeros_.back(); }
+}
+
+void JJBlock::store() const {
+    for (int64_t j = 0; j < size(); ++j) {
+        auto& d = *devices_[j];
+        d.pn1_  = p1[j];
+        d.pn2_  = p2[j];
+        d.pn3_  = p3[j];
+        d.pn4_  = p4[j];
+        d.phi0_ = phi0[j];
+        d.vn1_  = v1[j];
+        d.vn2_  = v2[j];
+        d.vn3_  = v3[j];
+        d.vn4_  = v4[j];
+        d.vn5_  = v5[j];
+        d.vn6_  = v6[j];
+    }
+}
+
+void JJBlock::draw_noise(double step) {
+    // The noise functions share one stream, so every draw takes the next number
+    for (const auto& j : noiseOrder_) { noise_[j] = devices_[j]->thermalNoise.value().value(step); }
+}
+
+bool JJBlock::stamp(const std::vector<double>& x,
+                    std::vector<double>&       b,
+                    int64_t                    i,
+                    double                     step,
+                    double                     h,
+                    bool                       checkStep,
+                    bool&                      needsLU,
+                    int64_t                    from,
+                    int64_t                    to) {
+    const int64_t n     = size();
+    // Junctions stamped, chunks of them only run on the threads for all junctions
+    const int64_t first = to < 0 ? 0 : blockStart_.at(from);
+    const int64_t last  = to < 0 ? n : blockStart_.at(to);
+    const bool    split = parallel_ && to < 0;
+    // Thermal noise current of the normal resistance, drawn beforehand for a range of blocks
+    if (to < 0) { draw_noise(step); }
+    for (const auto& j : within(noisy_, first, last)) {
+        if (pos[j] >= 0) { b[pos[j]] -= noise_[j]; }
+        if (neg[j] >= 0) { b[neg[j]] += noise_[j]; }
+    }
+    // Node values of the last step, phase and voltage in phase mode, voltage and phase in voltage mode
+    for (const auto& j : within(posGnd_, first, last)) { p1[j] = x[pos[j]]; }
+    for (const auto& j : within(gndNeg_, first, last)) { p1[j] = -x[neg[j]]; }
+    for (const auto& j : within(posNeg_, first, last)) { p1[j] = x[pos[j]] - x[neg[j]]; }
+    for (const auto& j : within(gndGnd_, first, last)) { p1[j] = 0.0; }
+    // The junctions are independent from here, chunks of them are stamped in parallel if enabled
+    const double      phaseFactor = (1.0 / Constants::SIGMA) * ((2.0 * h) / 3.0);
+    std::atomic<bool> tooLarge    = false;
+    Parallel::chunks(split, last - first, [&](int64_t begin, int64_t end) {
+        begin += first;
+        end += first;
+        if (i > 0) {
+            if (atyp_ == AnalysisType::Voltage) {
+                for (int64_t j = begin; j < end; ++j) {
+                    v1[j] = p1[j];
+                    p1[j] = x[variable[j]];
+                }
+            } else {
+                for (int64_t j = begin; j < end; ++j) { v1[j] = x[variable[j]]; }
+            }
+        }
+        // Guess voltage (V0) and phase (P0)
+        for (int64_t j = begin; j < end; ++j) {
+            v0[j]   = (5.0 / 2.0) * v1[j] - 2.0 * v2[j] + (1.0 / 2.0) * v3[j];
+            phi0[j] = (4.0 / 3.0) * p1[j] - (1.0 / 3.0) * p2[j] + phaseFactor * v0[j];
+        }
+        // Ensure timestep is not too large. The phase step is compared truncated to
+        // whole radians, matching the integer abs the scalar check always used.
+        if (checkStep) {
+            bool large = false;
+            for (int64_t j = begin; j < end; ++j) {
+                large |= std::abs(std::trunc(phi0[j] - p1[j])) > (0.20 * 2 * Constants::PI);
+            }
+            if (large) { tooLarge = true; }
+        }
+    });
+    if (tooLarge) { return false; }
+    Parallel::chunks(split, last - first, [&](int64_t begin, int64_t end) {
+        begin += first;
+        end += first;
+        if (atyp_ == AnalysisType::Voltage) {
+            // (hbar / 2 * e) ( -(2 / h) φp1 + (1 / 2h) φp2 )
+            for (int64_t j = begin; j < end; ++j) {
+                b[variable[j]] = (Constants::SIGMA) * (-(2.0 / h) * p1[j] + (1.0 / (2.0 * h)) * p2[j]);
+            }
+        } else {
+            // (4 / 3) φp1 - (1/3) φp2
+            for (int64_t j = begin; j < end; ++j) { b[variable[j]] = (4.0 / 3.0) * p1[j] - (1.0 / 3.0) * p2[j]; }
+        }
+        for (int64_t j = begin; j < end; ++j) {
+            p4[j] = p3[j];
+            p3[j] = p2[j];
+            p2[j] = p1[j];
+            v6[j] = v5[j];
+            v5[j] = v4[j];
+            v4[j] = v3[j];
+            v3[j] = v2[j];
+        }
+    });
+    // Update junction transition
+    for (const auto& j : within(switching_, first, last)) {
+        auto& d = *devices_[j];
+        if (d.update_value(v0[j])) { needsLU = true; }
+        it[j] = d.it_;
+        g[j]  = d.matrixInfo.nonZeros_.back();
+    }
+    Parallel::chunks(split, last - first, [&](int64_t begin, int64_t end) {
+        begin += first;
+        end += first;
+        // Ic * sin (phi * (φ0 - φ)), summing the harmonics by recurrence
+        for (int64_t j = begin; j < end; ++j) {
+            double phase = phi0[j] - phiOff[j];
+            sinKm1_[j]   = 0.0;
+            sinK_[j]     = std::sin(phase);
+            sinPhi[j]    = 0.0;
+            if (harmonics_ > 1) { twoCos_[j] = 2.0 * std::cos(phase); }
+        }
+        for (int64_t k = 0; k < harmonics_; ++k) {
+            const double* a = &cpr[k * n];
+            for (int64_t j = begin; j < end; ++j) {
+                sinPhi[j] += ic[j] * (a[j] * sinK_[j]);
+                double next = twoCos_[j] * sinK_[j] - sinKm1_[j];
+                sinKm1_[j]  = sinK_[j];
+                sinK_[j]    = next;
+            }
+        }
+        // -(hR / h + 2RC) * (Ic sin (φ0) - 2C / h Vp1 + C/2h Vp2 + It)
+        for (int64_t j = begin; j < end; ++j) {
+            b[current[j]] = g[j] * (sinPhi[j] - (((2 * c[j]) / h) * v1[j]) + ((c[j] / (2.0 * h)) * v2[j]) + it[j]);
+        }
+    });
+    // Temperature dependent current phase relation
+    for (const auto& j : within(tDep_, first, last)) {
+        auto&       d             = *devices_[j];
+        const auto& model         = d.model_;
+        const auto& cprs          = model.cpr();
+        double      sin2_half_phi = 0.0;
+        for (int harm = 0; harm < cprs.size(); ++harm) {
+            sin2_half_phi += cprs.at(harm) * sin((harm + 1) * (phi0[j] - model.phiOff()) / 2);
+        }
+        sin2_half_phi  = sin2_half_phi * sin2_half_phi;
+        double sin_phi = 0.0;
+        for (int harm = 0; harm < cprs.size(); ++harm) {
+            sin_phi += cprs.at(harm) * sin((harm + 1) * (phi0[j] - model.phiOff()));
+        }
+        double sqrt_part = sqrt(1 - model.d() * sin2_half_phi);
+        b[current[j]] =
+                // -(hR / h + 2RC) *(
+                g[j]
+                * ((
+                           // (π * Δ / 2 * e * Rn)
+                           ((Constants::PI * d.del_) / (2 * Constants::EV * model.rn()))
+                           // * (sin(φ0 - φ) / √(1 - D * sin²((φ0 - φ) / 2))
+                           * (sin_phi / sqrt_part)
+                           // * tanh(Δ / (2 * kB * T) * √(1 - D * sin²((φ0 - φ) / 2)))
+                           * tanh(d.del_ / (2 * Constants::BOLTZMANN * model.t()) * sqrt_part))
+                   // - 2C / h Vp1
+                   - (((2 * model.c()) / h) * v1[j])
+                   // + C/2h Vp2
+                   + ((model.c() / (2.0 * h)) * v2[j])
+                   // + It)
+                   + it[j]);
+    }
+    for (int64_t j = first; j < last; ++j) { v2[j] = v1[j]; }
+    return true;
+}
@@ -11,8 +11,11 @@ LUSolve::LUSolve() {
     nrhs  = 1;
     trans = TRANS;
     set_default_options(&options);
-    options.Equil = NO;
-    options.Trans = trans;
+    options.Equil           = NO;
+    options.Trans           = trans;
+    // Required by is_stable() to judge the pivots reused during refactorization
+    options.PivotGrowth     = YES;
+    options.ConditionNumber = YES;
 }
 
 void LUSolve::create_matrix(int64_t                 shape,
@@ -47,6 +50,11 @@ void LUSolve::create_matrix(int64_t                 shape,
 bool LUSolve::is_stable() { return ((info > 0 || rcond < 1e-8 || rpg > 1e8) == false); }
 
 void LUSolve::factorize(bool symbolic) {
+    // A full factorization allocates new L and U, release the previous ones
+    if (!symbolic && constructed) {
+        Destroy_SuperNode_Matrix(&L);
+        Destroy_CompCol_Matrix(&U);
+    }
     options.Fact = symbolic ? SamePattern_SameRowPerm : DOFACT;
     dgssvx(&options,
            &A,
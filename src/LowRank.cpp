@@ -0,0 +1,95 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/LowRank.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace JoSIM;
+
+void LowRankUpdate::clear() {
+    pos_.clear();
+    delta_.clear();
+    z_.clear();
+    s_.clear();
+    piv_.clear();
+}
+
+bool LowRankUpdate::update(const std::vector<double>& nz, int64_t maxRank, const solver_t& solve) {
+    std::vector<int64_t> pos;
+    std::vector<double>  delta;
+    // Find every entry that no longer matches the factorized matrix
+    for (int64_t p = 0; p < static_cast<int64_t>(nz.size()); ++p) {
+        if (nz.at(p) != baseNz_.at(p)) {
+            if (static_cast<int64_t>(pos.size()) == maxRank) { return false; }
+            pos.emplace_back(p);
+            delta.emplace_back(nz.at(p) - baseNz_.at(p));
+        }
+    }
+    // Z = A^-1 U, reusing the columns of entries that were already pending
+    std::vector<std::vector<double>> z(pos.size());
+    for (int64_t k = 0; k < static_cast<int64_t>(pos.size()); ++k) {
+        auto it = std::find(pos_.begin(), pos_.end(), pos.at(k));
+        if (it != pos_.end()) {
+            z.at(k) = std::move(z_.at(it - pos_.begin()));
+        } else {
+            z.at(k).resize(size_, 0.0);
+            z.at(k).at(nzRow_.at(pos.at(k))) = 1.0;
+            solve(z.at(k));
+        }
+    }
+    pos_   = std::move(pos);
+    delta_ = std::move(delta);
+    z_     = std::move(z);
+    return factor_capacitance();
+}
+
+bool LowRankUpdate::factor_capacitance() {
+    int64_t m = rank();
+    // S = D^-1 + V^T Z
+    s_.assign(m * m, 0.0);
+    for (int64_t j = 0; j < m; ++j) {
+        for (int64_t k = 0; k < m; ++k) { s_.at(j * m + k) = z_.at(k).at(nzCol_.at(pos_.at(j))); }
+        s_.at(j * m + j) += 1.0 / delta_.at(j);
+    }
+    double scale = 0.0;
+    for (const auto& v : s_) { scale = std::max(scale, std::fabs(v)); }
+    // LU with partial pivoting, rejecting near singular corrections
+    piv_.resize(m);
+    for (int64_t k = 0; k < m; ++k) {
+        int64_t p = k;
+        for (int64_t i = k + 1; i < m; ++i) {
+            if (std::fabs(s_.at(i * m + k)) > std::fabs(s_.at(p * m + k))) { p = i; }
+        }
+        piv_.at(k) = p;
+        if (std::fabs(s_.at(p * m + k)) <= 1E-12 * scale) { return false; }
+        if (p != k) {
+            for (int64_t j = 0; j < m; ++j) { std::swap(s_.at(k * m + j), s_.at(p * m + j)); }
+        }
+        for (int64_t i = k + 1; i < m; ++i) {
+            s_.at(i * m + k) /= s_.at(k * m + k);
+            for (int64_t j = k + 1; j < m; ++j) { s_.at(i * m + j) -= s_.at(i * m + k) * s_.at(k * m + j); }
+        }
+    }
+    return true;
+}
+
+void LowRankUpdate::correct(std::vector<double>& x) const {
+    int64_t             m = rank();
+    // t = S^-1 V^T y
+    std::vector<double> t(m);
+    for (int64_t j = 0; j < m; ++j) { t.at(j) = x.at(nzCol_.at(pos_.at(j))); }
+    for (int64_t k = 0; k < m; ++k) { std::swap(t.at(k), t.at(piv_.at(k))); }
+    for (int64_t i = 0; i < m; ++i) {
+        for (int64_t j = 0; j < i; ++j) { t.at(i) -= s_.at(i * m + j) * t.at(j); }
+    }
+    for (int64_t i = m - 1; i >= 0; --i) {
+        for (int64_t j = i + 1; j < m; ++j) { t.at(i) -= s_.at(i * m + j) * t.at(j); }
+        t.at(i) /= s_.at(i * m + i);
+    }
+    // x = y - Z t
+    for (int64_t k = 0; k < m; ++k) {
+        for (int64_t i = 0; i < static_cast<int64_t>(z_.at(k).size()); ++i) { x.at(i) -= z_.at(k).at(i) * t.at(k); }
+    }
+}
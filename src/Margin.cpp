@@ -0,0 +1,208 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/Margin.hpp"
+
+#include "JoSIM/Batch.hpp"
+#include "JoSIM/Constants.hpp"
+#include "JoSIM/Errors.hpp"
+#include "JoSIM/FileOutputType.hpp"
+#include "JoSIM/Matrix.hpp"
+#include "JoSIM/Misc.hpp"
+#include "JoSIM/Parameters.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace JoSIM;
+
+namespace {
+// Trace name as written to the output files, without quotes and in upper case like the control tokens
+std::string trace_name(const Trace& trace) {
+    std::string name;
+    for (auto c : trace.name_) {
+        if (c != '"') { name += static_cast<char>(std::toupper(static_cast<unsigned char>(c))); }
+    }
+    return name;
+}
+
+// Number of times the phase in data crossed to another multiple of 2pi
+int64_t switches(const std::vector<double>& data) {
+    int64_t count = 0;
+    for (auto j = 1; j < data.size(); ++j) {
+        count += std::abs(std::llround(data.at(j) / (2 * Constants::PI))
+                          - std::llround(data.at(j - 1) / (2 * Constants::PI)));
+    }
+    return count;
+}
+
+// Value of the trace data sampled at times, linearly interpolated at time t
+double sample(const std::vector<double>& times, const std::vector<double>& data, double t) {
+    auto k = std::upper_bound(times.begin(), times.end(), t) - times.begin();
+    if (k == 0) { return data.front(); }
+    if (k == times.size()) { return data.back(); }
+    double w = (t - times.at(k - 1)) / (times.at(k) - times.at(k - 1));
+    return data.at(k - 1) + w * (data.at(k) - data.at(k - 1));
+}
+} // namespace
+
+Margin::Margin(const Input& iObj) {
+    for (const auto& c : iObj.controls) {
+        if (c.empty() || c.front() != "MARGIN") { continue; }
+        for (auto k = 1; k < c.size(); ++k) {
+            ParameterName name(c.at(k), std::nullopt);
+            if (iObj.parameters.count(name) == 0) {
+                Errors::control_errors(ControlErrors::ANALYSIS_PARAM_NOT_FOUND, c.at(k));
+            }
+            params_.emplace_back(name);
+        }
+    }
+    // .pass TRACE [TRACE ...] [TOL=VALUE | SWITCHES=COUNT]
+    for (const auto& c : iObj.controls) {
+        if (c.empty() || c.front() != "PASS") { continue; }
+        auto& criterion = criteria_.emplace_back();
+        for (auto k = 1; k < c.size(); ++k) {
+            if (c.at(k).rfind("TOL=", 0) == 0) {
+                criterion.tol = parse_param(c.at(k).substr(4), iObj.parameters);
+            } else if (c.at(k).rfind("SWITCHES=", 0) == 0) {
+                criterion.switches = static_cast<int64_t>(parse_param(c.at(k).substr(9), iObj.parameters));
+            } else {
+                criterion.traces.emplace_back(c.at(k));
+            }
+        }
+        if (criterion.traces.empty() || (criterion.tol && criterion.switches)
+            || (criterion.tol && criterion.tol.value() < 0) || (criterion.switches && criterion.switches.value() < 0)) {
+            Errors::control_errors(ControlErrors::INVALID_PASS, Misc::vector_to_string(c));
+        }
+    }
+    if (auto r = iObj.find_option("MARGINRANGE")) { range_ = parse_param(r.value(), iObj.parameters); }
+    if (auto r = iObj.find_option("MARGINRES")) { resolution_ = parse_param(r.value(), iObj.parameters); }
+    threads_ = Batch::threads(iObj, 2 * params_.size());
+}
+
+bool Margin::probe(const Input& iObj, int64_t param, double factor) const {
+    Input              probeInp = iObj;
+    // Scale the expression of the parameter, in fixed notation since expressions read a signed exponent as an
+    // operator, and parse everything depending on it again
+    const auto&        name     = params_.at(param);
+    std::ostringstream expression;
+    expression << "(" << iObj.parameters.at(name).get_expression() << ")*" << std::fixed << std::setprecision(17)
+               << factor;
+    Batch::assign(probeInp, {{name, expression.str()}});
+    // Every probe draws the same spread and noise as the nominal run
+    auto        oObj = Batch::simulate(probeInp, 0, false, symbolic_.get());
+    const auto& time = oObj.traces.front().data_;
+    for (const auto& check : checks_) {
+        const auto& data    = oObj.traces.at(check.trace).data_;
+        const auto& nominal = nominal_.traces.at(check.trace).data_;
+        if (data.empty()) { return false; }
+        if (!check.tol) {
+            if (switches(data) != check.switches) { return false; }
+        } else if (!check.whole) {
+            if (std::abs(data.back() - nominal.back()) >= check.tol.value()) { return false; }
+        } else {
+            // Probes may store their points at other times if the step adapts
+            const auto& nominalTime = nominal_.traces.front().data_;
+            for (auto j = 0; j < nominal.size(); ++j) {
+                if (std::abs(sample(time, data, nominalTime.at(j)) - nominal.at(j)) > check.tol.value()) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void Margin::bisect(const Input& iObj, int64_t task) {
+    int64_t param     = task / 2;
+    double  direction = task % 2 == 0 ? -1.0 : 1.0;
+    auto&   margin    = task % 2 == 0 ? results_.at(param).lower : results_.at(param).upper;
+    // The nominal value passes, find where the circuit starts failing
+    if (probe(iObj, param, 1.0 + direction * range_)) {
+        margin = range_;
+        return;
+    }
+    double pass = 0.0, fail = range_;
+    while (fail - pass > resolution_) {
+        double mid = 0.5 * (pass + fail);
+        if (probe(iObj, param, 1.0 + direction * mid)) {
+            pass = mid;
+        } else {
+            fail = mid;
+        }
+    }
+    margin = pass;
+}
+
+void Margin::run(const Input& iObj) {
+    results_.assign(params_.size(), Result());
+    for (auto k = 0; k < params_.size(); ++k) {
+        results_.at(k).nominal = iObj.parameters.at(params_.at(k)).get_value().value();
+    }
+    // Every probe has the sparsity pattern of the nominal netlist
+    Input  patternInp = iObj;
+    Matrix pattern;
+    pattern.create_matrix(patternInp);
+    symbolic_ = std::make_unique<SharedSymbolic>(pattern);
+    // Nominal run, the reference for every probe
+    nominal_ = Batch::simulate(iObj, 0, true, symbolic_.get());
+    checks_.clear();
+    for (const auto& criterion : criteria_) {
+        for (const auto& name : criterion.traces) {
+            auto i = std::find_if(nominal_.traces.begin() + 1, nominal_.traces.end(),
+                                  [&](const Trace& t) { return trace_name(t) == name; });
+            if (i == nominal_.traces.end() || i->data_.empty()) {
+                Errors::control_errors(ControlErrors::PASS_TRACE_NOT_FOUND, name);
+            }
+            auto& check = checks_.emplace_back();
+            check.trace = i - nominal_.traces.begin();
+            check.tol   = criterion.tol;
+            if (!check.tol) { check.switches = criterion.switches.value_or(switches(i->data_)); }
+        }
+    }
+    // Without .pass controls only the final phase of every junction is checked, it has to end within pi of the
+    // nominal phase
+    if (criteria_.empty()) {
+        for (auto i = 1; i < nominal_.traces.size(); ++i) {
+            const auto& trace = nominal_.traces.at(i);
+            if (trace.type_ == 'P' && !trace.data_.empty()) {
+                auto& check = checks_.emplace_back();
+                check.trace = i;
+                check.tol   = Constants::PI;
+                check.whole = false;
+            }
+        }
+        if (checks_.empty()) { Errors::control_errors(ControlErrors::MARGIN_NO_PHASE); }
+    }
+    Batch::run(
+            2 * params_.size(), threads_, [&](int64_t t) { bisect(iObj, t); }, "Bisecting margins", iObj.argMin);
+}
+
+void Margin::write_margins(const Input& iObj) const {
+    char          delimiter = ',';
+    std::ofstream outfile;
+    if (iObj.cli_output_file) {
+        if (iObj.cli_output_file.value().type() == FileOutputType::Dat) { delimiter = ' '; }
+        outfile.open(iObj.cli_output_file.value().name());
+        if (!outfile.is_open()) {
+            Errors::output_errors(OutputErrors::CANNOT_OPEN_FILE, iObj.cli_output_file.value().name());
+            return;
+        }
+    } else {
+        delimiter = ' ';
+    }
+    std::ostream& os = iObj.cli_output_file ? outfile : std::cout;
+    os << "parameter" << delimiter << "nominal" << delimiter << "low" << delimiter << "high" << delimiter << "lower"
+       << delimiter << "upper\n";
+    for (auto k = 0; k < params_.size(); ++k) {
+        const auto& r = results_.at(k);
+        os << params_.at(k).name() << std::scientific << std::setprecision(6) << delimiter << r.nominal << delimiter
+           << r.nominal * (1.0 - r.lower) << delimiter << r.nominal * (1.0 + r.upper) << std::fixed
+           << std::setprecision(2) << delimiter << -100.0 * r.lower << delimiter << 100.0 * r.upper << "\n";
+    }
+}
@@ -31,6 +31,14 @@ void Matrix::create_matrix(Input& iObj) {
     handle_mutual_inductance(iObj);
     // Create the compressed storage row format required for simulation
     create_csr();
+    // Only junctions can request a smaller step during simulation, keep what is needed to retime
+    if (!components.junctionIndices.empty()) {
+        initialComponents_ = components;
+        initialSourcegen_  = sourcegen;
+        initialNoise_      = Rng::noise();
+        initialSpread_     = Rng::spread();
+        initialStep_       = iObj.transSim.tstep();
+    }
 }
 
 void Matrix::setup(Input& iObj) {
@@ -354,6 +362,20 @@ void Matrix::reduce_step(Input& iObj) {
     relevantTraces.clear();
 }
 
+void Matrix::retime(Input& iObj) {
+    // Start over from the devices as created, this also clears all history
+    components    = initialComponents_;
+    sourcegen     = initialSourcegen_;
+    Rng::noise()  = initialNoise_;
+    Rng::spread() = initialSpread_;
+    // Rescale the step dependent entries, the sparsity pattern is unchanged
+    double factor = iObj.transSim.tstep() / initialStep_;
+    for (auto& i : components.devices) {
+        std::visit([&](auto& device) { device.update_timestep(factor); }, i);
+    }
+    create_nz();
+}
+
 void Matrix::create_csr() {
     // Create the non zero vector
     create_nz();
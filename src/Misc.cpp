@@ -254,3 +254,18 @@ double Misc::grand() {
     // return r;
     return Rng::normal01_noise();
 }
+
+std::array<double, 4> Misc::lagrange_weights(const std::array<double, 4>& nodes, double x) {
+    std::array<double, 4> w;
+    for (int64_t k = 0; k < 4; ++k) {
+        w.at(k) = 1.0;
+        for (int64_t l = 0; l < 4; ++l) {
+            if (l != k) { w.at(k) *= (x - nodes.at(l)) / (nodes.at(k) - nodes.at(l)); }
+        }
+    }
+    return w;
+}
+
+int64_t Misc::stencil(int64_t n, double p) {
+    return std::clamp(static_cast<int64_t>(std::floor(p)) - 1, static_cast<int64_t>(0), n - 4);
+}
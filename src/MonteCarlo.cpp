@@ -0,0 +1,50 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/MonteCarlo.hpp"
+
+#include "JoSIM/Batch.hpp"
+#include "JoSIM/Parameters.hpp"
+
+#include <algorithm>
+
+using namespace JoSIM;
+
+MonteCarlo::MonteCarlo(const Input& iObj) {
+    if (auto mc = iObj.find_option("MC")) {
+        samples_ = std::max(static_cast<int64_t>(parse_param(mc.value(), iObj.parameters)), static_cast<int64_t>(0));
+    }
+    threads_ = Batch::threads(iObj, samples_);
+}
+
+void MonteCarlo::run_sample(const Input& iObj, int64_t sample) {
+    // The netlist is the same for every sample, only check it once
+    auto  oObj = Batch::simulate(iObj, sample, sample == 0);
+    // Keep the final value of every trace, skipping the time
+    auto& row  = rows_.at(sample);
+    for (int64_t i = 1; i < oObj.traces.size(); ++i) {
+        const auto& data = oObj.traces.at(i).data_;
+        row.emplace_back(data.empty() ? 0.0 : data.back());
+    }
+    if (sample == 0) { traces_ = std::move(oObj.traces); }
+}
+
+void MonteCarlo::run(const Input& iObj) {
+    rows_.assign(samples_, std::vector<double>());
+    Batch::run(
+            samples_, threads_, [&](int64_t k) { run_sample(iObj, k); }, "Simulating Monte Carlo samples", iObj.argMin);
+}
+
+void MonteCarlo::write_summary(const Input& iObj) const {
+    Output summary;
+    summary.traces.emplace_back("sample");
+    summary.traces.back().type_ = 'T';
+    for (int64_t k = 0; k < samples_; ++k) { summary.traces.back().data_.emplace_back(static_cast<double>(k)); }
+    for (int64_t i = 1; i < traces_.size(); ++i) {
+        summary.traces.emplace_back(traces_.at(i).name_);
+        summary.traces.back().type_     = traces_.at(i).type_;
+        summary.traces.back().fileIndex = traces_.at(i).fileIndex;
+        for (const auto& row : rows_) { summary.traces.back().data_.emplace_back(row.at(i - 1)); }
+    }
+    summary.format_output(iObj);
+}
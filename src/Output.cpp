@@ -5,14 +5,17 @@
 
 #include "JoSIM/AnalysisType.hpp"
 #include "JoSIM/Constants.hpp"
+#include "JoSIM/Decimator.hpp"
 #include "JoSIM/Errors.hpp"
 #include "JoSIM/FileOutputType.hpp"
 #include "JoSIM/Input.hpp"
 #include "JoSIM/ProgressBar.hpp"
 #include "JoSIM/Simulation.hpp"
+#include "JoSIM/TraceStore.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -21,55 +24,83 @@
 
 using namespace JoSIM;
 
-Output::Output(Input& iObj, Matrix& mObj, Simulation& sObj) {
+Output::Output(Input& iObj, Matrix& mObj, Simulation& sObj, int64_t instance) : instance(instance) {
     // Write the output in type agnostic format
     write_output(iObj, mObj, sObj);
     // Format the output into the relevant type
+    format_output(iObj);
+}
+
+Output::Output(Input& iObj, Matrix& mObj, const Results& results) {
+    write_output(iObj, mObj, results);
+    format_output(iObj);
+}
+
+void Output::format_output(const Input& iObj) {
     if (iObj.cli_output_file) {
         if (iObj.cli_output_file.value().type() == FileOutputType::Csv) {
-            format_csv_or_dat(iObj.cli_output_file.value().name(), ',', iObj.argMin);
+            format_csv_or_dat(instance_name(iObj.cli_output_file.value().name()), ',', iObj.argMin);
         } else if (iObj.cli_output_file.value().type() == FileOutputType::Dat) {
-            format_csv_or_dat(iObj.cli_output_file.value().name(), ' ', iObj.argMin);
+            format_csv_or_dat(instance_name(iObj.cli_output_file.value().name()), ' ', iObj.argMin);
         } else if (iObj.cli_output_file.value().type() == FileOutputType::Raw) {
-            format_raw(iObj.cli_output_file.value().name(), iObj.argMin);
+            format_raw(instance_name(iObj.cli_output_file.value().name()), iObj.argMin, -1, iObj.argBinary);
+        } else if (iObj.cli_output_file.value().type() == FileOutputType::Binary) {
+            format_raw(instance_name(iObj.cli_output_file.value().name()), iObj.argMin, -1, true);
+        } else if (iObj.cli_output_file.value().type() == FileOutputType::Store) {
+            format_store(instance_name(iObj.cli_output_file.value().name()));
         }
     }
     if (!iObj.output_files.empty()) {
         for (auto i = 0; i < iObj.output_files.size(); ++i) {
             if (iObj.output_files.at(i).type() == FileOutputType::Csv) {
-                format_csv_or_dat(iObj.output_files.at(i).name(), ',', iObj.argMin, i);
+                format_csv_or_dat(instance_name(iObj.output_files.at(i).name()), ',', iObj.argMin, i);
             } else if (iObj.output_files.at(i).type() == FileOutputType::Dat) {
-                format_csv_or_dat(iObj.output_files.at(i).name(), ' ', iObj.argMin, i);
+                format_csv_or_dat(instance_name(iObj.output_files.at(i).name()), ' ', iObj.argMin, i);
             } else if (iObj.output_files.at(i).type() == FileOutputType::Raw) {
-                format_raw(iObj.output_files.at(i).name(), iObj.argMin, i);
+                format_raw(instance_name(iObj.output_files.at(i).name()), iObj.argMin, i, iObj.argBinary);
+            } else if (iObj.output_files.at(i).type() == FileOutputType::Binary) {
+                format_raw(instance_name(iObj.output_files.at(i).name()), iObj.argMin, i, true);
+            } else if (iObj.output_files.at(i).type() == FileOutputType::Store) {
+                format_store(instance_name(iObj.output_files.at(i).name()), i);
             }
         }
     }
     if (!iObj.cli_output_file && iObj.output_files.empty()) { format_cout(iObj.argMin); }
 }
 
+std::string Output::instance_name(const std::string& filename) const {
+    if (instance == 0) { return filename; }
+    std::filesystem::path path(filename);
+    auto                  stem = path.stem().string() + "_" + std::to_string(instance);
+    return path.replace_filename(stem + path.extension().string()).string();
+}
+
 void Output::write_output(const Input& iObj, Matrix& mObj, Simulation& sObj) {
+    write_output(iObj, mObj, sObj.instance_results(instance));
+}
+
+void Output::write_output(const Input& iObj, Matrix& mObj, const Results& results) {
+    // Traces filtered while simulating only need their labels
+    if (!results.printTimes.empty()) {
+        traces.emplace_back("time");
+        traces.back().type_ = 'T';
+        traces.back().data_ = results.printTimes;
+        int64_t k           = 0;
+        for (auto& i : labels(iObj, mObj)) {
+            i.data_ = results.printTraces.at(k++);
+            traces.emplace_back(std::move(i));
+        }
+        return;
+    }
     // Shorthand
-    auto&   x           = sObj.results.xVector;
-    auto&   t           = sObj.results.timeAxis;
+    auto&   x           = results.xVector;
+    auto&   t           = results.timeAxis;
     auto&   tran        = iObj.transSim;
-    // Create downsampling FIR window, use Hanning function with odd number of taps.
+    // Create downsampling FIR window, a Hanning function with an odd number of taps.
     // The FIR filter is centered around the requested point in time, i. e. looks into the past and future.
-    int64_t halffirsize = static_cast<int64_t>(tran.prfirwindow() <= 0. ? 0 : .5 * tran.prfirwindow() / tran.tstep());
-    int64_t firsize     = halffirsize * 2 + 1; // Guarantees odd number of taps or 1 in case of disabled filter.
-    std::vector<double> firwindow;
-    firwindow.reserve(firsize);
-    // Calculate Hanning function 1 - cos(x) with x in ]0; 2*pi[.
-    // For firsize == 1 (filter disabled), this results in a firwindow = {1.0},
-    //   i. e. a convolution with delta(x), which has no effect.
-    double firsum = 0.0;
-    for (int64_t k = 0; k < firsize; k++) {
-        double hanning  = 1. - cos(((double) k + 0.5) * (2. * Constants::PI / (double) firsize));
-        firsum         += hanning;
-        firwindow.emplace_back(hanning);
-    }
-    double firscale = 1. / firsum; // Normalize Hanning function to sum(firwindow) = 1
-    for (auto& hanning : firwindow) { hanning = firscale * hanning; }
+    auto    firwindow   = Decimator::window(tran);
+    int64_t firsize     = static_cast<int64_t>(firwindow.size());
+    int64_t halffirsize = firsize / 2;
     // Indices to print
     std::vector<int64_t> result_indices;
     for (auto i = 0; i < t.size(); ++i) {
@@ -78,7 +109,8 @@ void Output::write_output(const Input& iObj, Matrix& mObj, Simulation& sObj) {
             break;
         }
     }
-    double next_print_point = tran.prstart() + tran.prstep();
+    // Results of a periodic steady state start at the period found rather than at t=0
+    double next_print_point = std::max(tran.prstart(), t.front()) + tran.prstep();
     for (auto i = static_cast<size_t>(result_indices.back()); i < t.size(); ++i) {
         if (t.at(i) >= next_print_point) {
             result_indices.emplace_back(i);
@@ -340,10 +372,32 @@ void Output::write_output(const Input& iObj, Matrix& mObj, Simulation& sObj) {
     }
 }
 
+std::vector<Trace> Output::labels(const Input& iObj, const Matrix& mObj) {
+    std::vector<Trace> labelled;
+    for (const auto& i : mObj.relevantTraces) {
+        labelled.emplace_back(i.deviceLabel.value());
+        labelled.back().fileIndex = i.fIndex;
+        labelled.back().type_     = i.storageType == StorageType::Voltage ? 'V'
+                                  : i.storageType == StorageType::Phase   ? 'P'
+                                                                          : 'I';
+    }
+    if (mObj.relevantTraces.empty()) {
+        bool voltage = iObj.argAnal == AnalysisType::Voltage;
+        for (const auto& i : mObj.nm) {
+            labelled.emplace_back((voltage ? "V(" : "P(") + i.first + ")");
+            labelled.back().type_ = voltage ? 'V' : 'P';
+        }
+    }
+    return labelled;
+}
+
 void Output::format_csv_or_dat(const std::string& filename, const char& delimiter, bool argmin, int64_t fIndex) {
     std::vector<int64_t> tIndices = {0};
     for (auto i = 1; i < traces.size(); ++i) {
-        if (traces.at(i).fileIndex == fIndex || fIndex == -1) { tIndices.emplace_back(i); }
+        // Sweep columns go to every file
+        if (traces.at(i).fileIndex == fIndex || fIndex == -1 || traces.at(i).type_ == 'S') {
+            tIndices.emplace_back(i);
+        }
     }
     std::ofstream outfile(filename);
     outfile << std::setprecision(15);
@@ -378,15 +432,18 @@ void Output::format_csv_or_dat(const std::string& filename, const char& delimite
 }
 
 // Writes the output to a standard spice raw file
-void Output::format_raw(const std::string& filename, bool argmin, int64_t fIndex) {
+void Output::format_raw(const std::string& filename, bool argmin, int64_t fIndex, bool binary) {
     std::vector<int64_t> tIndices = {0};
     for (auto i = 1; i < traces.size(); ++i) {
-        if (traces.at(i).fileIndex == fIndex || fIndex == -1) { tIndices.emplace_back(i); }
+        // Sweep columns go to every file
+        if (traces.at(i).fileIndex == fIndex || fIndex == -1 || traces.at(i).type_ == 'S') {
+            tIndices.emplace_back(i);
+        }
     }
     // Variable to store the total number of points to be saved
     int64_t       loopsize = 0;
-    // Opens an output stream with provided file name
-    std::ofstream outfile(filename);
+    // Opens an output stream with provided file name, binary values must not be translated
+    std::ofstream outfile(filename, binary ? std::ios::out | std::ios::binary : std::ios::out);
     // Set the output presicion
     outfile << std::setprecision(6);
     // Ensure that the file could be opened
@@ -424,12 +481,17 @@ void Output::format_raw(const std::string& filename, bool argmin, int64_t fIndex
                     name = name.substr(0, name.size() - 1);
                     // Append '#branch' since currents always flow in branches
                     outfile << " " << i << " " << name << "#branch Current\n";
+                    // If this is a sweep index or swept parameter
+                } else if (traces.at(tIndices.at(i)).type_ == 'S') {
+                    outfile << " " << i << " " << name << " Sweep\n";
                 }
             }
             // Start filling the values
-            outfile << "Values:\n";
-            int64_t     pointSizeSpacing = std::to_string(loopsize).length() + 1;
-            ProgressBar bar;
+            outfile << (binary ? "Binary:\n" : "Values:\n");
+            int64_t           pointSizeSpacing = std::to_string(loopsize).length() + 1;
+            // Little endian bytes of every variable of a point
+            std::vector<char> point(binary ? 8 * tIndices.size() : 0);
+            ProgressBar       bar;
             if (!argmin) {
                 bar.create_thread();
                 bar.set_bar_width(30);
@@ -440,6 +502,15 @@ void Output::format_raw(const std::string& filename, bool argmin, int64_t fIndex
             }
             for (int64_t i = 0; i < loopsize; ++i) {
                 if (!argmin) { bar.update(static_cast<float>(i)); }
+                if (binary) {
+                    for (auto j = 0; j < tIndices.size(); ++j) {
+                        uint64_t bits;
+                        std::memcpy(&bits, &traces.at(tIndices.at(j)).data_.at(i), sizeof(bits));
+                        for (int64_t k = 0; k < 8; ++k) { point.at(8 * j + k) = static_cast<char>(bits >> (8 * k)); }
+                    }
+                    outfile.write(point.data(), point.size());
+                    continue;
+                }
                 // Point and time value
                 outfile << std::left << std::setw(pointSizeSpacing) << i << traces.at(0).data_.at(i) << "\n";
                 // Fill in rest of variable values
@@ -465,6 +536,26 @@ void Output::format_raw(const std::string& filename, bool argmin, int64_t fIndex
     }
 }
 
+// Writes the output to a native trace store, the columns are written straight from the traces
+void Output::format_store(const std::string& filename, int64_t fIndex) {
+    if (traces.empty()) { Errors::output_errors(OutputErrors::NOTHING_SPECIFIED); }
+    std::vector<std::string>                names;
+    std::vector<char>                       types;
+    std::vector<const std::vector<double>*> columns;
+    for (auto i = 0; i < traces.size(); ++i) {
+        // Sweep columns go to every file
+        if (i == 0 || traces.at(i).fileIndex == fIndex || fIndex == -1 || traces.at(i).type_ == 'S') {
+            // Names are stored without the double quotes that delimit them in CSV files
+            std::string name = traces.at(i).name_;
+            name.erase(std::remove(name.begin(), name.end(), '\"'), name.end());
+            names.emplace_back(name);
+            types.emplace_back(traces.at(i).type_);
+            columns.emplace_back(&traces.at(i).data_);
+        }
+    }
+    TraceStore::write(filename, names, types, columns);
+}
+
 void Output::format_cout(const bool& argMin) {
     if (!argMin) {
         for (auto i = 0; i < traces.size() - 1; ++i) { std::cout << traces.at(i).name_ << " "; }
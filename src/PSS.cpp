@@ -0,0 +1,236 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/PSS.hpp"
+
+#include "JoSIM/Constants.hpp"
+#include "JoSIM/Errors.hpp"
+#include "JoSIM/Parameters.hpp"
+#include "JoSIM/Parareal.hpp"
+#include "JoSIM/Simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <numeric>
+
+using namespace JoSIM;
+
+namespace {
+// Solve the small dense system a x = b of size n (row major) by Gaussian elimination with partial pivoting
+std::vector<double> dense_solve(std::vector<double> a, std::vector<double> b, int64_t n) {
+    for (int64_t c = 0; c < n; ++c) {
+        int64_t p = c;
+        for (int64_t r = c + 1; r < n; ++r) {
+            if (std::abs(a.at(r * n + c)) > std::abs(a.at(p * n + c))) { p = r; }
+        }
+        if (a.at(p * n + c) == 0.0) { return std::vector<double>(n, 0.0); }
+        for (int64_t k = 0; k < n; ++k) { std::swap(a.at(c * n + k), a.at(p * n + k)); }
+        std::swap(b.at(c), b.at(p));
+        for (int64_t r = c + 1; r < n; ++r) {
+            double f = a.at(r * n + c) / a.at(c * n + c);
+            for (int64_t k = c; k < n; ++k) { a.at(r * n + k) -= f * a.at(c * n + k); }
+            b.at(r) -= f * b.at(c);
+        }
+    }
+    for (int64_t c = n - 1; c >= 0; --c) {
+        for (int64_t k = c + 1; k < n; ++k) { b.at(c) -= a.at(c * n + k) * b.at(k); }
+        b.at(c) /= a.at(c * n + c);
+    }
+    return b;
+}
+} // namespace
+
+void PSS::load(const Input& iObj) {
+    // By default the iterated period starts after the first one
+    period_ = 0.0;
+    if (auto ps = iObj.find_option("PSS")) { period_ = std::max(parse_param(ps.value(), iObj.parameters), 0.0); }
+    start_ = period_;
+    if (auto pb = iObj.find_option("PSSSTART")) { start_ = std::max(parse_param(pb.value(), iObj.parameters), 0.0); }
+    tol_ = DEFAULT_TOL;
+    if (auto pt = iObj.find_option("PSSTOL")) { tol_ = std::max(parse_param(pt.value(), iObj.parameters), 0.0); }
+    iterations_ = DEFAULT_ITERATIONS;
+    if (auto pi = iObj.find_option("PSSITER")) {
+        iterations_
+                = std::max(static_cast<int64_t>(parse_param(pi.value(), iObj.parameters)), static_cast<int64_t>(1));
+    }
+}
+
+std::vector<std::vector<int64_t>> PSS::turn_groups(const Matrix& mObj, AnalysisType atyp) {
+    // Phases may advance by whole turns every period. In voltage mode the junction phases only enter through their
+    // sine. In phase mode the nodes joined by inductors or phase sources have to advance together, and those tied
+    // to ground through them or used by controlled sources cannot advance at all.
+    std::vector<std::vector<int64_t>> groups;
+    const auto&                       c = mObj.components;
+    if (atyp == AnalysisType::Phase) {
+        int64_t              fixed = static_cast<int64_t>(mObj.nm.size());
+        std::vector<int64_t> parent(fixed + 1);
+        std::iota(parent.begin(), parent.end(), 0);
+        auto root = [&](int64_t k) {
+            while (parent.at(k) != k) {
+                parent.at(k) = parent.at(parent.at(k));
+                k            = parent.at(k);
+            }
+            return k;
+        };
+        auto join = [&](const int_o& a, const int_o& b) {
+            parent.at(root(a.value_or(fixed))) = root(b.value_or(fixed));
+        };
+        auto tie = [&](const auto& d) {
+            join(d.indexInfo.posIndex_, d.indexInfo.negIndex_);
+        };
+        auto hold = [&](const auto& d) {
+            for (const auto& n : {d.indexInfo.posIndex_, d.indexInfo.negIndex_, d.posIndex2_, d.negIndex2_}) {
+                join(n, std::nullopt);
+            }
+        };
+        for (auto j : c.inductorIndices) { tie(std::get<Inductor>(c.devices.at(j))); }
+        for (auto j : c.psIndices) { tie(std::get<PhaseSource>(c.devices.at(j))); }
+        for (auto j : c.vcvsIndices) { hold(std::get<VCVS>(c.devices.at(j))); }
+        for (auto j : c.ccvsIndices) { hold(std::get<CCVS>(c.devices.at(j))); }
+        for (auto j : c.vccsIndices) { hold(std::get<VCCS>(c.devices.at(j))); }
+        for (auto j : c.cccsIndices) { hold(std::get<CCCS>(c.devices.at(j))); }
+        std::vector<int64_t> number(fixed + 1, -1);
+        for (int64_t n = 0; n < fixed; ++n) {
+            auto r = root(n);
+            if (r == root(fixed)) { continue; }
+            if (number.at(r) == -1) {
+                number.at(r) = groups.size();
+                groups.emplace_back();
+            }
+            groups.at(number.at(r)).emplace_back(n);
+        }
+    } else {
+        for (auto j : c.junctionIndices) { groups.push_back({std::get<JJ>(c.devices.at(j)).variableIndex_}); }
+    }
+    return groups;
+}
+
+void PSS::run(Simulation& sim, Matrix& mObj) const {
+    // Periods start on the step grid, after enough steps to replay the device history from
+    int64_t replay = Simulation::REPLAY_STEPS;
+    int64_t first  = std::max(static_cast<int64_t>(std::round(start_ / sim.baseStep_)), replay + 1);
+    int64_t period = static_cast<int64_t>(std::round(period_ / sim.baseStep_));
+    if (period <= replay) {
+        Errors::control_errors(
+                ControlErrors::PSS_UNSUPPORTED, "periods shorter than " + std::to_string(replay + 1) + " steps");
+        sim.trans_sim(mObj);
+        return;
+    }
+    auto groups = turn_groups(mObj, sim.atyp_);
+    // The state a period starts from is the window of solutions ending at its first step, newest first
+    auto window = Parareal::propagate(sim, mObj, {}, 0, first, false, replay + 1);
+    if (window.empty()) { return; }
+    int64_t variables = static_cast<int64_t>(window.front().size());
+    int64_t length    = static_cast<int64_t>(window.size()) * variables;
+    // End states of the last few periods and their differences to the states they started from
+    std::deque<std::vector<double>> images, residuals;
+    std::vector<double>             origin, lastTurns;
+    bool                            accelerated = false, converged = false;
+    int64_t                         iterations  = 0;
+    while (!converged && iterations < iterations_) {
+        ++iterations;
+        origin   = window.front();
+        auto end = Parareal::propagate(sim, mObj, window, first, first + period, true, replay + 1);
+        if (end.empty()) {
+            // An extrapolated start can be too far off for the step, continue from the last period instead
+            if (!accelerated) { return; }
+            sim.needsTR_ = false;
+            for (int64_t p = 0; p < length; ++p) { window.at(p / variables).at(p % variables) = images.back().at(p); }
+            images.clear();
+            residuals.clear();
+            accelerated = false;
+            continue;
+        }
+        // Remove the whole turns every group advanced on average
+        std::vector<double> turns(groups.size());
+        for (int64_t k = 0; k < groups.size(); ++k) {
+            double advance = 0.0;
+            for (auto e : groups.at(k)) { advance += end.front().at(e) - origin.at(e); }
+            turns.at(k) = 2 * Constants::PI * std::round(advance / groups.at(k).size() / (2 * Constants::PI));
+            for (auto e : groups.at(k)) {
+                for (auto& x : end) { x.at(e) -= turns.at(k); }
+            }
+        }
+        // Largest change of any variable over the period, relative to its largest magnitude
+        std::vector<double> image(length), residual(length), scale(variables, 0.0), difference(variables, 0.0);
+        for (int64_t p = 0; p < length; ++p) {
+            int64_t j = p / variables, e = p % variables;
+            image.at(p)      = end.at(j).at(e);
+            residual.at(p)   = image.at(p) - window.at(j).at(e);
+            scale.at(e)      = std::max({scale.at(e), std::abs(image.at(p)), std::abs(window.at(j).at(e))});
+            difference.at(e) = std::max(difference.at(e), std::abs(residual.at(p)));
+        }
+        // Tiny variables are not compared below the rounding errors of the largest one
+        double change = 0.0, rounding = ROUNDING * *std::max_element(scale.begin(), scale.end());
+        for (int64_t e = 0; e < variables; ++e) {
+            if (difference.at(e) > rounding) { change = std::max(change, difference.at(e) / scale.at(e)); }
+        }
+        if (change <= tol_) {
+            converged = true;
+            break;
+        }
+        // Anderson acceleration: start the next period from the combination of the last ones whose residuals
+        // cancel best. Periods that removed different turns are not combined, a fraction of a turn is not a state
+        // the circuit can reach. The combination also restarts once the residual grows.
+        auto norm = [](const std::vector<double>& v) {
+            double n = 0.0;
+            for (auto x : v) { n += x * x; }
+            return n;
+        };
+        if (!residuals.empty() && (turns != lastTurns || norm(residual) > norm(residuals.back()))) {
+            images.clear();
+            residuals.clear();
+        }
+        lastTurns = turns;
+        images.emplace_back(image);
+        residuals.emplace_back(residual);
+        if (images.size() > MEMORY + 1) {
+            images.pop_front();
+            residuals.pop_front();
+        }
+        auto    next = image;
+        int64_t m    = static_cast<int64_t>(residuals.size()) - 1;
+        accelerated  = m > 0;
+        if (accelerated) {
+            // Least squares over the residual differences, through the normal equations with a little damping
+            std::vector<double> a(m * m, 0.0), b(m, 0.0);
+            double              largest = 0.0;
+            for (int64_t i = 0; i < m; ++i) {
+                for (int64_t p = 0; p < length; ++p) {
+                    double di = residuals.at(i + 1).at(p) - residuals.at(i).at(p);
+                    b.at(i) += di * residual.at(p);
+                    for (int64_t k = 0; k <= i; ++k) {
+                        a.at(i * m + k) += di * (residuals.at(k + 1).at(p) - residuals.at(k).at(p));
+                    }
+                }
+                for (int64_t k = 0; k < i; ++k) { a.at(k * m + i) = a.at(i * m + k); }
+                largest = std::max(largest, a.at(i * m + i));
+            }
+            for (int64_t i = 0; i < m; ++i) { a.at(i * m + i) += ROUNDING * largest; }
+            auto gamma = dense_solve(a, b, m);
+            for (int64_t i = 0; i < m; ++i) {
+                for (int64_t p = 0; p < length; ++p) {
+                    next.at(p) -= gamma.at(i) * (images.at(i + 1).at(p) - images.at(i).at(p));
+                }
+            }
+        }
+        for (int64_t p = 0; p < length; ++p) { window.at(p / variables).at(p % variables) = next.at(p); }
+    }
+    if (!converged) { Errors::control_errors(ControlErrors::PSS_NOT_CONVERGED, std::to_string(iterations_)); }
+    // The results hold the last period, starting from the state it was simulated from
+    auto& results = sim.results;
+    for (auto j = 0; j < results.xVector.size(); ++j) {
+        if (results.xVector.at(j)) {
+            auto& r = results.xVector.at(j).value();
+            r.insert(r.begin(), origin.at(j));
+        }
+    }
+    results.timeAxis.insert(results.timeAxis.begin(), first * sim.baseStep_);
+    sim.stats.pssIterations = iterations;
+    if (!sim.minOut_) {
+        std::cout << "Periodic steady state: " << iterations << " periods of " << period << " steps, "
+                  << (converged ? "converged" : "not converged") << "\n";
+    }
+}
@@ -0,0 +1,287 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/Parareal.hpp"
+
+#include "JoSIM/Batch.hpp"
+#include "JoSIM/Errors.hpp"
+#include "JoSIM/Misc.hpp"
+#include "JoSIM/Parameters.hpp"
+#include "JoSIM/Simulation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+using namespace JoSIM;
+
+void Parareal::load(const Input& iObj) {
+    // The slices are iterated on a pool of threads
+    slices_ = 0;
+    if (auto pr = iObj.find_option("PARAREAL")) {
+        slices_ = std::max(static_cast<int64_t>(parse_param(pr.value(), iObj.parameters)), static_cast<int64_t>(0));
+    }
+    coarseStride_ = DEFAULT_COARSE_STRIDE;
+    if (auto cs = iObj.find_option("PARAREALSTRIDE")) {
+        coarseStride_
+                = std::max(static_cast<int64_t>(parse_param(cs.value(), iObj.parameters)), static_cast<int64_t>(2));
+    }
+    tol_ = DEFAULT_TOL;
+    if (auto pt = iObj.find_option("PARAREALTOL")) { tol_ = std::max(parse_param(pt.value(), iObj.parameters), 0.0); }
+    threads_ = Batch::threads(iObj, slices_);
+}
+
+std::vector<std::vector<double>> Parareal::propagate(Simulation&                             sim,
+                                                     Matrix&                                 mObj,
+                                                     const std::vector<std::vector<double>>& window,
+                                                     int64_t                                 first,
+                                                     int64_t                                 last,
+                                                     bool                                    store,
+                                                     int64_t                                 width) {
+    sim.b_.resize(mObj.rp.size(), 0.0);
+    for (auto& r : sim.results.xVector) {
+        if (r) { r.value().clear(); }
+    }
+    sim.results.timeAxis.clear();
+    sim.historyCount_ = 0;
+    sim.needsTR_      = false;
+    int64_t start     = first;
+    if (first == 0) {
+        // The first slice starts at rest like a serial transient, on a propagator that has not stepped yet
+        if (sim.startup_) {
+            for (int64_t i = -sim.startup_steps(); i < 0; ++i) {
+                sim.setup_b(mObj, i, i * sim.stepSize_);
+                if (sim.needsTR_) { return {}; }
+                sim.x_ = sim.b_;
+                sim.solve(mObj);
+            }
+        }
+    } else {
+        // Other slices replay the device history from the window they start from. The history of the first
+        // replayed steps is left over from elsewhere, their junction phase steps are meaningless.
+        bool check     = sim.checkStep_;
+        sim.checkStep_ = false;
+        bool ok        = sim.rebuild_history(mObj, window, sim.baseStep_, first);
+        sim.checkStep_ = check;
+        if (!ok) {
+            sim.needsTR_ = true;
+            return {};
+        }
+        start = first + sim.stride_;
+    }
+    std::vector<std::vector<double>> tail;
+    for (int64_t i = start; i <= last; i += sim.stride_) {
+        sim.setup_b(mObj, i, i * sim.baseStep_);
+        if (sim.needsTR_) { return {}; }
+        sim.x_ = sim.b_;
+        sim.solve(mObj);
+        ++sim.stats.timeSteps;
+        sim.push_history();
+        if (store) {
+            for (auto j = 0; j < sim.results.xVector.size(); ++j) {
+                if (sim.results.xVector.at(j)) { sim.results.xVector.at(j).value().emplace_back(sim.x_.at(j)); }
+            }
+            sim.results.timeAxis.emplace_back(i * sim.baseStep_);
+        }
+        if (sim.stride_ == 1 && i > last - width) { tail.emplace_back(sim.x_); }
+    }
+    if (sim.stride_ == 1) {
+        std::reverse(tail.begin(), tail.end());
+        return tail;
+    }
+    // Interpolate the fine window from the coarse solutions
+    auto                             coarse = sim.recent_history();
+    auto                             count  = static_cast<int64_t>(coarse.size());
+    std::vector<std::vector<double>> end(width, std::vector<double>(sim.x_.size(), 0.0));
+    for (int64_t j = 0; j < width; ++j) {
+        double p = (count - 1) - static_cast<double>(j) / sim.stride_;
+        auto   s = Misc::stencil(count, p);
+        auto   w = Misc::lagrange_weights({static_cast<double>(s), s + 1.0, s + 2.0, s + 3.0}, p);
+        for (int64_t e = 0; e < sim.x_.size(); ++e) {
+            for (int64_t k = 0; k < 4; ++k) { end.at(j).at(e) += w.at(k) * coarse.at(count - 1 - (s + k)).at(e); }
+        }
+    }
+    return end;
+}
+
+void Parareal::run(Simulation& sim, Input& iObj, Matrix& mObj) const {
+    auto    begin  = std::chrono::steady_clock::now();
+    int64_t slices = slices_;
+    // Slices start on the coarse grid and are long enough for the coarse propagator to rebuild its history
+    int64_t length = (sim.simSize_ - 1) / slices / coarseStride_ * coarseStride_;
+    if (length < Simulation::HISTORY_DEPTH * coarseStride_) {
+        Errors::control_errors(ControlErrors::PARAREAL_UNSUPPORTED,
+                               "slices shorter than " + std::to_string(Simulation::HISTORY_DEPTH) + " coarse steps");
+        sim.trans_sim(mObj);
+        return;
+    }
+    // Fine solutions at the end of a slice, enough to restart any propagator from
+    int64_t              width = Simulation::REPLAY_STEPS * coarseStride_ + 1;
+    std::vector<int64_t> bounds(slices + 1);
+    for (int64_t n = 0; n < slices; ++n) { bounds.at(n) = n * length; }
+    bounds.back() = sim.simSize_ - 1;
+    // Every propagator steps its own copy of the matrix, the fine ones are shared by the threads through a pool
+    Matrix                                   coarseMatrix = mObj;
+    std::unique_ptr<Simulation>              coarse(new Simulation(iObj, coarseMatrix, sim, coarseStride_));
+    std::vector<Matrix>                      fineMatrices(threads_, mObj);
+    std::vector<std::unique_ptr<Simulation>> fine;
+    std::vector<int64_t>                     idle;
+    for (int64_t t = 0; t < threads_; ++t) {
+        fine.emplace_back(new Simulation(iObj, fineMatrices.at(t), sim, 1));
+        idle.emplace_back(t);
+    }
+    std::mutex pool;
+    // Window every slice starts from, and the coarse prediction from it
+    std::vector<std::vector<std::vector<double>>> starts(slices), predictions(slices), ends(slices);
+    bool                                          failed = false;
+    for (int64_t n = 0; n + 1 < slices && !failed; ++n) {
+        predictions.at(n)
+                = propagate(*coarse, coarseMatrix, starts.at(n), bounds.at(n), bounds.at(n + 1), false, width);
+        failed           = predictions.at(n).empty();
+        starts.at(n + 1) = predictions.at(n);
+    }
+    std::vector<Results> sliceResults(slices);
+    std::vector<double>  fineTimes(slices, 0.0);
+    // Slices before this one start from their converged state
+    int64_t              exact      = 0;
+    int64_t              iterations = 0;
+    while (!failed && exact < slices) {
+        ++iterations;
+        std::atomic<bool> fineFailed = false;
+        Batch::run(
+                slices - exact,
+                threads_,
+                [&](int64_t k) {
+                    int64_t n     = exact + k;
+                    auto    start = std::chrono::steady_clock::now();
+                    if (n == 0) {
+                        // The first slice needs a propagator that has not stepped yet
+                        Matrix     matrix = mObj;
+                        Simulation first(iObj, matrix, sim, 1);
+                        ends.at(n) = propagate(first, matrix, starts.at(n), bounds.at(n), bounds.at(n + 1), true, width);
+                        sliceResults.at(n) = first.results;
+                        first.release();
+                        std::lock_guard<std::mutex> lock(pool);
+                        sim.stats.add(first.stats);
+                    } else {
+                        int64_t t;
+                        {
+                            std::lock_guard<std::mutex> lock(pool);
+                            t = idle.back();
+                            idle.pop_back();
+                        }
+                        auto& f      = fine.at(t);
+                        auto& matrix = fineMatrices.at(t);
+                        ends.at(n)   = propagate(*f, matrix, starts.at(n), bounds.at(n), bounds.at(n + 1), true, width);
+                        sliceResults.at(n) = f->results;
+                        std::lock_guard<std::mutex> lock(pool);
+                        idle.emplace_back(t);
+                    }
+                    // Slices after the first may start too far off for the transient step, only the first is exact
+                    if (ends.at(n).empty() && n == exact) { fineFailed = true; }
+                    if (iterations == 1) {
+                        auto elapsed    = std::chrono::steady_clock::now() - start;
+                        fineTimes.at(n) = std::chrono::duration<double>(elapsed).count();
+                    }
+                },
+                "Parareal iteration",
+                true);
+        if (fineFailed) {
+            failed = true;
+            break;
+        }
+        // Correct the slice boundaries serially with the coarse propagator, the first one becomes exact
+        auto                variables = ends.at(exact).front().size();
+        std::vector<double> scale(variables, 0.0), difference(variables, 0.0);
+        bool                diverged = false;
+        for (int64_t n = exact; n + 1 < slices; ++n) {
+            std::vector<std::vector<double>> next;
+            if (n == exact) {
+                // The prediction cancels, the fine solution is exact
+                next = ends.at(n);
+            } else {
+                auto prediction
+                        = propagate(*coarse, coarseMatrix, starts.at(n), bounds.at(n), bounds.at(n + 1), false, width);
+                if (prediction.empty()) {
+                    failed = true;
+                    break;
+                }
+                next = prediction;
+                if (ends.at(n).empty()) {
+                    // Without a fine solution the slice only has the coarse prediction
+                    diverged = true;
+                } else {
+                    for (int64_t j = 0; j < next.size(); ++j) {
+                        for (int64_t e = 0; e < next.at(j).size(); ++e) {
+                            next.at(j).at(e) += ends.at(n).at(j).at(e) - predictions.at(n).at(j).at(e);
+                        }
+                    }
+                }
+                predictions.at(n) = std::move(prediction);
+            }
+            for (int64_t j = 0; j < next.size(); ++j) {
+                for (int64_t e = 0; e < variables; ++e) {
+                    auto d           = std::abs(next.at(j).at(e) - starts.at(n + 1).at(j).at(e));
+                    difference.at(e) = std::max(difference.at(e), d);
+                }
+            }
+            starts.at(n + 1) = std::move(next);
+        }
+        // Largest change of any variable, relative to its largest magnitude at any of the boundaries
+        for (int64_t n = 1; n < slices; ++n) {
+            for (const auto& x : starts.at(n)) {
+                for (int64_t e = 0; e < variables; ++e) { scale.at(e) = std::max(scale.at(e), std::abs(x.at(e))); }
+            }
+        }
+        // Tiny variables are not compared below the rounding errors of the largest one
+        double change = 0.0, rounding = ROUNDING * *std::max_element(scale.begin(), scale.end());
+        for (int64_t e = 0; e < variables; ++e) {
+            if (difference.at(e) > rounding) { change = std::max(change, difference.at(e) / scale.at(e)); }
+        }
+        ++exact;
+        if (ends.back().empty()) { diverged = true; }
+        if (!diverged && change <= tol_) { exact = slices; }
+    }
+    for (const auto& f : fine) {
+        f->release();
+        sim.stats.add(f->stats);
+    }
+    coarse->release();
+    sim.stats.add(coarse->stats);
+    if (failed) {
+        // A fine propagator needs a smaller step
+        sim.needsTR_ = true;
+        return;
+    }
+    // Join the results of the slices
+    auto& results = sim.results;
+    results.timeAxis.clear();
+    for (auto& r : results.xVector) {
+        if (r) { r.value().clear(); }
+    }
+    for (const auto& s : sliceResults) {
+        for (int64_t j = 0; j < results.xVector.size(); ++j) {
+            if (results.xVector.at(j)) {
+                const auto& v = s.xVector.at(j).value();
+                results.xVector.at(j).value().insert(results.xVector.at(j).value().end(), v.begin(), v.end());
+            }
+        }
+        results.timeAxis.insert(results.timeAxis.end(), s.timeAxis.begin(), s.timeAxis.end());
+    }
+    // The first fine sweep covers the whole transient, as a serial run would
+    double wall   = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    double serial = 0.0;
+    for (const auto& t : fineTimes) { serial += t; }
+    sim.stats.pararealIterations = iterations;
+    sim.stats.pararealSpeedup    = wall > 0.0 ? serial / wall : 0.0;
+    if (!sim.minOut_) {
+        std::cout << "Parareal transient: " << slices << " slices on " << threads_ << " threads, " << iterations
+                  << " iterations, speedup " << std::fixed << std::setprecision(2) << sim.stats.pararealSpeedup
+                  << std::defaultfloat << "\n";
+    }
+}
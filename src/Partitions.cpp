@@ -0,0 +1,154 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+#ifndef SLU
+#    include "JoSIM/Partitions.hpp"
+
+#    include "JoSIM/Errors.hpp"
+#    include "JoSIM/Parallel.hpp"
+
+#    include <algorithm>
+#    include <numeric>
+
+using namespace JoSIM;
+
+void Partitions::load(const Matrix& mObj) {
+    clear();
+    int64_t              n = static_cast<int64_t>(mObj.rp.size()) - 1;
+    // Union of the variables sharing an entry
+    std::vector<int64_t> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&](int64_t k) {
+        while (parent.at(k) != k) {
+            parent.at(k) = parent.at(parent.at(k));
+            k            = parent.at(k);
+        }
+        return k;
+    };
+    for (int64_t r = 0; r < n; ++r) {
+        for (int64_t p = mObj.rp.at(r); p < mObj.rp.at(r + 1); ++p) { parent.at(root(r)) = root(mObj.ci.at(p)); }
+    }
+    // Number the blocks in order of their first variable
+    std::vector<int64_t> number(n, -1), local(n);
+    for (int64_t r = 0; r < n; ++r) {
+        auto b = root(r);
+        if (number.at(b) == -1) {
+            number.at(b) = blocks_.size();
+            blocks_.emplace_back();
+        }
+        auto& rows = blocks_.at(number.at(b)).rows;
+        local.at(r) = rows.size();
+        rows.emplace_back(r);
+    }
+    if (!enabled()) {
+        blocks_.clear();
+        return;
+    }
+    for (auto& b : blocks_) {
+        b.rp.emplace_back(0);
+        for (auto r : b.rows) {
+            for (int64_t p = mObj.rp.at(r); p < mObj.rp.at(r + 1); ++p) {
+                b.ci.emplace_back(local.at(mObj.ci.at(p)));
+                b.entries.emplace_back(p);
+            }
+            b.rp.emplace_back(b.ci.size());
+        }
+        b.nz.resize(b.entries.size());
+        b.x.resize(b.rows.size());
+        klu_l_defaults(&b.common);
+        b.symbolic = klu_l_analyze(b.rows.size(), b.rp.data(), b.ci.data(), &b.common);
+    }
+    state_.assign(blocks_.size(), 0);
+}
+
+bool Partitions::factor(Block& b) {
+    if (b.numeric != nullptr) { klu_l_free_numeric(&b.numeric, &b.common); }
+    b.numeric = klu_l_factor(b.rp.data(), b.ci.data(), b.nz.data(), b.symbolic, &b.common);
+    if (b.numeric == nullptr) { return false; }
+    klu_l_rcond(b.symbolic, b.numeric, &b.common);
+    b.rcond = b.common.rcond;
+    return true;
+}
+
+void Partitions::factorize(const Matrix& mObj) {
+    Parallel::tasks(parallel_, size(), [&](int64_t k) {
+        auto& b = blocks_.at(k);
+        for (int64_t e = 0; e < b.entries.size(); ++e) { b.nz.at(e) = mObj.nz.at(b.entries.at(e)); }
+        state_.at(k) = factor(b) ? 0 : 1;
+    });
+    if (std::count(state_.begin(), state_.end(), 1) > 0) {
+        Errors::simulation_errors(SimulationErrors::MATRIX_SINGULAR);
+    }
+}
+
+char Partitions::refactor(Block& b, const Matrix& mObj, double tolerance) {
+    bool change = false;
+    for (int64_t e = 0; e < b.entries.size(); ++e) {
+        double value = mObj.nz.at(b.entries.at(e));
+        change       = change || value != b.nz.at(e);
+        b.nz.at(e)   = value;
+    }
+    if (!change) { return 0; }
+    // Refactor using the pivot order of the previous factorization
+    if (klu_l_refactor(b.rp.data(), b.ci.data(), b.nz.data(), b.symbolic, b.numeric, &b.common)
+        && klu_l_rcond(b.symbolic, b.numeric, &b.common) && b.common.rcond >= tolerance * b.rcond) {
+        return 0;
+    }
+    // Pivots degraded too much, do a full factorization
+    return factor(b) ? 2 : 1;
+}
+
+bool Partitions::refactorize(const Matrix& mObj, double tolerance) {
+    Parallel::tasks(parallel_, size(), [&](int64_t k) { state_.at(k) = refactor(blocks_.at(k), mObj, tolerance); });
+    if (std::count(state_.begin(), state_.end(), 1) > 0) {
+        Errors::simulation_errors(SimulationErrors::MATRIX_SINGULAR);
+    }
+    return std::count(state_.begin(), state_.end(), 2) == 0;
+}
+
+void Partitions::solve(std::vector<double>& x) {
+    // Every block reads and writes its own variables of x
+    Parallel::tasks(parallel_, size(), [&](int64_t k) {
+        auto& b = blocks_.at(k);
+        for (int64_t i = 0; i < b.rows.size(); ++i) { b.x.at(i) = x.at(b.rows.at(i)); }
+        state_.at(k) = klu_l_tsolve(b.symbolic, b.numeric, b.rows.size(), 1, b.x.data(), &b.common) ? 0 : 1;
+        for (int64_t i = 0; i < b.rows.size(); ++i) { x.at(b.rows.at(i)) = b.x.at(i); }
+    });
+    if (std::count(state_.begin(), state_.end(), 1) > 0) {
+        Errors::simulation_errors(SimulationErrors::MATRIX_SINGULAR);
+    }
+}
+
+std::vector<int64_t> Partitions::block_of() const {
+    std::vector<int64_t> block;
+    for (int64_t k = 0; k < size(); ++k) {
+        for (auto r : blocks_.at(k).rows) {
+            if (r >= block.size()) { block.resize(r + 1, -1); }
+            block.at(r) = k;
+        }
+    }
+    return block;
+}
+
+char Partitions::refactor(int64_t k, const Matrix& mObj, double tolerance) {
+    return refactor(blocks_.at(k), mObj, tolerance);
+}
+
+bool Partitions::solve(int64_t k, const std::vector<double>& b, std::vector<double>& x) {
+    auto& block = blocks_.at(k);
+    for (int64_t i = 0; i < block.rows.size(); ++i) { block.x.at(i) = b.at(block.rows.at(i)); }
+    if (!klu_l_tsolve(block.symbolic, block.numeric, block.rows.size(), 1, block.x.data(), &block.common)) {
+        return false;
+    }
+    for (int64_t i = 0; i < block.rows.size(); ++i) { x.at(block.rows.at(i)) = block.x.at(i); }
+    return true;
+}
+
+void Partitions::clear() {
+    for (auto& b : blocks_) {
+        if (b.numeric != nullptr) { klu_l_free_numeric(&b.numeric, &b.common); }
+        if (b.symbolic != nullptr) { klu_l_free_symbolic(&b.symbolic, &b.common); }
+    }
+    blocks_.clear();
+    state_.clear();
+}
+#endif // SLU
@@ -17,9 +17,9 @@ static uint64_t mix_seed_(uint64_t x) {
     return x ^ (x >> 31);
 }
 
-void Rng::start_run(uint64_t seed) {
-    seed_                  = seed;
+Rng::Streams Rng::streams_;
 
+void Rng::seed_streams(Streams& streams, uint64_t seed) {
     // Derive independent stream seeds from base seed.
     const uint64_t sNoise  = mix_seed_(seed ^ 0x4E4F495345ULL);   // "NOISE"
     const uint64_t sSpread = mix_seed_(seed ^ 0x535052454144ULL); // "SPREAD"
@@ -27,12 +27,36 @@ void Rng::start_run(uint64_t seed) {
     std::seed_seq  seqN{uint32_t(sNoise), uint32_t(sNoise >> 32), 0x4E4F4953u};
     std::seed_seq  seqS{uint32_t(sSpread), uint32_t(sSpread >> 32), 0x53505244u};
 
-    noise_.seed(seqN);
-    spread_.seed(seqS);
+    streams.seed = seed;
+    streams.noise.seed(seqN);
+    streams.spread.seed(seqS);
+}
 
+void Rng::start_run(uint64_t seed) {
+    seed_ = seed;
+    seed_streams(streams_, seed);
     seeded_ = true;
 }
 
+Rng::Streams Rng::derive(uint64_t index) {
+    uint64_t seed = active().seed;
+    Streams  streams;
+    // Run 0 repeats the seed in use, later runs mix the index into it
+    seed_streams(streams, index == 0 ? seed : mix_seed_(seed ^ mix_seed_(index)));
+    return streams;
+}
+
+Rng::Streams* Rng::use(Streams* streams) {
+    Streams* previous = active_;
+    active_           = streams;
+    return previous;
+}
+
+Rng::Streams& Rng::active() {
+    if (!seeded_) { start_run_auto(); }
+    return active_ != nullptr ? *active_ : streams_;
+}
+
 void Rng::start_run_auto() {
     std::random_device rd;
     uint64_t           s  = (uint64_t(rd()) << 32) ^ uint64_t(rd());
@@ -41,8 +65,8 @@ void Rng::start_run_auto() {
 }
 
 void Rng::rewind() {
-    if (!seeded_) { start_run_auto(); }
-    start_run(seed_); // re-seed both engines from the same base seed
+    auto& streams = active();
+    seed_streams(streams, streams.seed); // re-seed both engines from the same seed
 }
 
 uint64_t Rng::base_seed() {
@@ -51,13 +75,11 @@ uint64_t Rng::base_seed() {
 }
 
 std::mt19937_64& Rng::noise() {
-    if (!seeded_) { start_run_auto(); }
-    return noise_;
+    return active().noise;
 }
 
 std::mt19937_64& Rng::spread() {
-    if (!seeded_) { start_run_auto(); }
-    return spread_;
+    return active().spread;
 }
 
 double Rng::normal01_(std::mt19937_64& eng, BMState& st) {
@@ -85,8 +107,8 @@ double Rng::normal01_(std::mt19937_64& eng, BMState& st) {
 }
 
 double Rng::normal01_noise() {
-    static thread_local BMState st;
-    return normal01_(noise(), st);
+    auto& streams = active();
+    return normal01_(streams.noise, streams.noiseSpare);
 }
 
 double Rng::normal_spread(double mean, double sigma) {
@@ -8,46 +8,110 @@
 #include "JoSIM/Constants.hpp"
 #include "JoSIM/Matrix.hpp"
 #include "JoSIM/Model.hpp"
+#include "JoSIM/Parallel.hpp"
 #include "JoSIM/ProgressBar.hpp"
 #include "JoSIM/Rng.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <iostream>
+#include <map>
+#include <unordered_map>
+#include <utility>
 
 using namespace JoSIM;
 
-Simulation::Simulation(Input& iObj, Matrix& mObj) {
-    while (needsTR_) {
-        // Do generic simulation setup for given step size
-        setup(iObj, mObj);
-        // Do solver setup
+SharedSymbolic::SharedSymbolic(const Matrix& mObj) : ci_(mObj.ci), rp_(mObj.rp) {
+#ifndef SLU
+    klu_l_defaults(&common_);
+    symbolic_ = klu_l_analyze(rp_.size() - 1, &rp_.front(), &ci_.front(), &common_);
+#endif
+}
+
+SharedSymbolic::~SharedSymbolic() {
+#ifndef SLU
+    klu_l_free_symbolic(&symbolic_, &common_);
+#endif
+}
+
+Simulation::Simulation(Input&                iObj,
+                       Matrix&               mObj,
+                       const SharedSymbolic* symbolic,
+                       StepMonitor           monitor,
+                       Stream*               stream,
+                       std::vector<Matrix>*  variants)
+    : monitor_(std::move(monitor)), stream_(stream), variants_(variants) {
+    // Do solver setup, the sparsity pattern does not depend on the step size
 #ifdef SLU
-        // SLU setup
-        lu.create_matrix(mObj.rp.size() - 1, mObj.nz, mObj.ci, mObj.rp);
-        lu.factorize();
+    // SLU setup
+    lu.create_matrix(mObj.rp.size() - 1, mObj.nz, mObj.ci, mObj.rp);
 #else
-        // KLU setup
-        simOK_ = klu_l_defaults(&Common_);
-        assert(simOK_);
+    // KLU setup
+    simOK_ = klu_l_defaults(&Common_);
+    assert(simOK_);
+    if (symbolic != nullptr && symbolic->matches(mObj)) {
+        Symbolic_     = symbolic->symbolic();
+        ownsSymbolic_ = false;
+    } else {
         Symbolic_ = klu_l_analyze(mObj.rp.size() - 1, &mObj.rp.front(), &mObj.ci.front(), &Common_);
-        Numeric_  = klu_l_factor(&mObj.rp.front(), &mObj.ci.front(), &mObj.nz.front(), Symbolic_, &Common_);
+    }
 #endif
+    // Run until the transient completes without needing a smaller step
+    while (needsTR_ || resume_) {
+        // Do generic simulation setup for given step size, unless resuming from a checkpoint
+        if (!resume_) {
+            setup(iObj, mObj);
+            factorize(mObj);
+        }
 
-        // Run transient simulation
-        trans_sim(mObj);
+        // Run transient simulation, only its periodic steady state or in parallel time slices if requested
+        if (pss_.enabled()) {
+            pss_.run(*this, mObj);
+        } else if (parareal_.enabled()) {
+            parareal_.run(*this, iObj, mObj);
+        } else {
+            trans_sim(mObj);
+        }
         // If step size is too large, reduce and try again
         if (needsTR_) { reduce_step(iObj, mObj); }
+    }
+    release();
+}
 
-        // Do solver cleanup
+Simulation::Simulation(Input& iObj, Matrix& mObj, const Simulation& parent, int64_t stride) {
 #ifdef SLU
-        // SLU cleanup
-        lu.free();
+    lu.create_matrix(mObj.rp.size() - 1, mObj.nz, mObj.ci, mObj.rp);
 #else
-        // KLU cleanup
-        klu_l_free_symbolic(&Symbolic_, &Common_);
-        klu_l_free_numeric(&Numeric_, &Common_);
+    simOK_ = klu_l_defaults(&Common_);
+    assert(simOK_);
+    Symbolic_     = parent.Symbolic_;
+    ownsSymbolic_ = false;
 #endif
+    setup(iObj, mObj);
+    minOut_    = true;
+    checkStep_ = stride == 1;
+    parareal_.disable();
+    factorize(mObj);
+    if (stride > 1) { set_stride(mObj, stride); }
+}
+
+void Simulation::release() {
+    // Do solver cleanup
+#ifdef SLU
+    // SLU cleanup
+    lu.free();
+#else
+    // KLU cleanup, cached factorizations are owned by the cache
+    if (ownsSymbolic_) { klu_l_free_symbolic(&Symbolic_, &Common_); }
+    partitions_.clear();
+    if (factorCache_.capacity() > 0) {
+        factorCache_.clear(&Common_);
+        Numeric_ = nullptr;
+    } else {
+        klu_l_free_numeric(&Numeric_, &Common_);
     }
+#endif
 }
 
 void Simulation::setup(Input& iObj, Matrix& mObj) {
@@ -55,25 +119,208 @@ void Simulation::setup(Input& iObj, Matrix& mObj) {
     simSize_  = iObj.transSim.simsize();
     atyp_     = iObj.argAnal;
     minOut_   = iObj.argMin;
+    parallel_ = iObj.argParallel;
     needsLU_  = false;
     needsTR_  = false;
     stepSize_ = iObj.transSim.tstep();
+    baseStep_ = stepSize_;
+    stride_   = 1;
+    quiet_    = 0;
     prstep_   = iObj.transSim.prstep();
     prstart_  = iObj.transSim.prstart();
     startup_  = iObj.transSim.startup();
+    // Junction switching can be handled as a low-rank correction instead of refactoring
+    if (auto lr = iObj.find_option("LOWRANK")) {
+        lowRankMax_ = std::max(static_cast<int64_t>(parse_param(lr.value(), iObj.parameters)), static_cast<int64_t>(0));
+    }
+#ifndef SLU
+    // Factorizations of recurring junction states can be cached, capacity given in MB
+    if (auto fc = iObj.find_option("FACTORCACHE")) {
+        factorCache_.capacity(static_cast<size_t>(std::max(parse_param(fc.value(), iObj.parameters), 0.0) * 1024 * 1024));
+    }
+#endif
+    // Checkpoints allow resuming with a halved step size instead of restarting
+    if (auto cp = iObj.find_option("CHECKPOINT")) {
+        checkpointInterval_
+                = std::max(static_cast<int64_t>(parse_param(cp.value(), iObj.parameters)), static_cast<int64_t>(0));
+    }
+    // Adaptive time stepping, tolerance on the local truncation error of the junction phases
+    if (auto ad = iObj.find_option("ADAPTIVE")) { lteTol_ = std::max(parse_param(ad.value(), iObj.parameters), 0.0); }
+    maxStride_ = DEFAULT_MAX_STRIDE;
+    if (auto ms = iObj.find_option("MAXSTEP")) {
+        // Steps are a power of two multiple of the transient step
+        double maxStep = parse_param(ms.value(), iObj.parameters);
+        maxStride_     = 1;
+        while (2 * maxStride_ * stepSize_ <= maxStep) { maxStride_ *= 2; }
+    }
+    // Transmission lines look up their delayed values by step index
+    if (lteTol_ > 0 && !mObj.components.txIndices.empty()) {
+        Errors::control_errors(ControlErrors::ADAPTIVE_WITH_TX);
+        lteTol_ = 0.0;
+    }
+    // Parallel-in-time transient and periodic steady state
+    parareal_.load(iObj);
+    pss_.load(iObj);
+    // Noise realizations or variants advanced in lockstep, sharing the matrix and its factorizations
+    int64_t ensembleSize = 1;
+#ifndef SLU
+    if (variants_ != nullptr) {
+        ensembleSize = static_cast<int64_t>(variants_->size()) + 1;
+    } else if (auto en = iObj.find_option("ENSEMBLE")) {
+        ensembleSize
+                = std::max(static_cast<int64_t>(parse_param(en.value(), iObj.parameters)), static_cast<int64_t>(1));
+    }
+#endif
+    // Slices start from an interpolated state, the step grid, delayed values and noise draws must not depend on
+    // what came before
+    if (parareal_.enabled()) {
+        std::optional<std::string> unsupported;
+        if (pss_.enabled()) {
+            unsupported = "periodic steady state analysis";
+        } else if (lteTol_ > 0) {
+            unsupported = "adaptive steps";
+        } else if (checkpointInterval_ > 0) {
+            unsupported = "checkpoints";
+        } else if (ensembleSize > 1) {
+            unsupported = "ensembles";
+        } else if (!mObj.components.txIndices.empty()) {
+            unsupported = "transmission lines";
+        } else if (has_noise(mObj)) {
+            unsupported = "noise";
+        }
+        if (unsupported) {
+            Errors::control_errors(ControlErrors::PARAREAL_UNSUPPORTED, unsupported);
+            parareal_.disable();
+        }
+    }
+    // Every period starts from the state it is given, like a Parareal slice
+    if (pss_.enabled()) {
+        std::optional<std::string> unsupported;
+        if (lteTol_ > 0) {
+            unsupported = "adaptive steps";
+        } else if (checkpointInterval_ > 0) {
+            unsupported = "checkpoints";
+        } else if (ensembleSize > 1) {
+            unsupported = "ensembles";
+        } else if (!mObj.components.txIndices.empty()) {
+            unsupported = "transmission lines";
+        } else if (has_noise(mObj)) {
+            unsupported = "noise";
+        }
+        if (unsupported) {
+            Errors::control_errors(ControlErrors::PSS_UNSUPPORTED, unsupported);
+            pss_.disable();
+        }
+    }
+    // A monitor follows the transient step by step
+    if (monitor_) {
+        parareal_.disable();
+        pss_.disable();
+    }
+    if (ensembleSize > 1) {
+        if (lteTol_ > 0 || checkpointInterval_ > 0) {
+            Errors::control_errors(ControlErrors::ENSEMBLE_FIXED_STEP);
+            lteTol_             = 0.0;
+            checkpointInterval_ = 0;
+        }
+        // Instances in different junction states are solved with different factorizations
+        lowRankMax_ = 0;
+#ifndef SLU
+        if (factorCache_.capacity() == 0) { factorCache_.capacity(DEFAULT_ENSEMBLE_CACHE * 1024 * 1024); }
+#endif
+    }
+#ifndef SLU
+    // Parts of the circuit joined only through transmission lines are factored apart. Low-rank updates, the
+    // factorization cache, ensembles and Parareal propagators work on the factorization of the whole matrix.
+    partitions_.clear();
+    auto pa = iObj.find_option("PARTITION");
+    if ((!pa || parse_param(pa.value(), iObj.parameters) != 0) && lowRankMax_ == 0 && factorCache_.capacity() == 0
+        && ensembleSize == 1 && !parareal_.enabled()) {
+        partitions_.load(mObj);
+        partitions_.parallel(parallel_);
+    }
+    stats.partitions = partitions_.enabled() ? partitions_.size() : 0;
+#endif
+    checkpoint_.reset();
+    history_.assign(HISTORY_DEPTH, std::vector<double>());
+    historyCount_ = 0;
+    // Compiled stamps of the linear devices, the per device loops remain for validation
+    auto sp      = iObj.find_option("STAMPPLAN");
+    bool planned = !sp || parse_param(sp.value(), iObj.parameters) != 0;
+    // In parallel the blocks of the partitioned matrix keep their devices together, so every block is assembled in
+    // the task solving it. Serial runs and adaptive steps assemble the whole matrix.
+    blockOf_.clear();
+#ifndef SLU
+    if (partitions_.enabled() && planned && lteTol_ == 0 && parallel_) { blockOf_ = partitions_.block_of(); }
+#endif
+    jjBlock_.load(mObj.components, atyp_, blockOf_);
+    jjBlock_.parallel(parallel_);
+    group_terminals(mObj);
+    stampPlan_.clear();
+    stampPlan_.parallel(parallel_);
+    if (planned) { stampPlan_.load(mObj.components, atyp_, stepSize_, blockOf_); }
+#ifndef SLU
+    setup_blocks(mObj);
+#endif
     x_.clear();
     x_.resize(mObj.branchIndex, 0.0);
-    if (!mObj.relevantTraces.empty()) {
+    // Transmission lines start without delayed values
+    for (const auto& j : mObj.components.txIndices) {
+        std::get<TransmissionLine>(mObj.components.devices.at(j)).reset_history();
+    }
+    // The traces are filtered while simulating unless the stored steps are resampled, rewound or simulated in pieces
+    decimator_.clear();
+    results.printTimes.clear();
+    results.printTraces.clear();
+    auto dc = iObj.find_option("DECIMATE");
+    if ((!dc || parse_param(dc.value(), iObj.parameters) != 0) && lteTol_ == 0 && checkpointInterval_ == 0
+        && ensembleSize == 1 && !parareal_.enabled() && !pss_.enabled() && !monitor_) {
+        decimator_.load(iObj, mObj);
+    }
+    if (decimator_.enabled() && stream_ != nullptr && stream_->enabled()) {
+        stream_->start();
+        decimator_.sink([this](double t, const std::vector<double>& row) { stream_->push(t, row); });
+    }
+    if (decimator_.enabled()) {
+        results.xVector.assign(mObj.branchIndex, std::nullopt);
+    } else if (!mObj.relevantTraces.empty()) {
         results.xVector.resize(mObj.branchIndex);
         for (const auto& i : mObj.relevantIndices) { results.xVector.at(i).emplace(); }
     } else {
         results.xVector.resize(mObj.branchIndex, std::vector<double>(0));
     }
+    setup_ensemble(mObj, ensembleSize);
+}
+
+void SolverStats::add(const SolverStats& other) {
+    factorizations += other.factorizations;
+    refactorizations += other.refactorizations;
+    lowRankUpdates += other.lowRankUpdates;
+    cacheHits += other.cacheHits;
+    cacheMisses += other.cacheMisses;
+    stepReductions += other.stepReductions;
+    checkpointResumes += other.checkpointResumes;
+    timeSteps += other.timeSteps;
+    rejectedSteps += other.rejectedSteps;
+    pararealIterations += other.pararealIterations;
+    // A ratio does not add up, keep the best speedup of the merged runs
+    pararealSpeedup = std::max(pararealSpeedup, other.pararealSpeedup);
+    partitions += other.partitions;
+    pssIterations += other.pssIterations;
+}
+
+int64_t Simulation::startup_steps() const {
+    int64_t startup = static_cast<int64_t>(2 * pow(10, (abs(log10(stepSize_)) - 12) * 2 + 1));
+    if (startup > 1000) { startup = 1000; }
+    return startup;
 }
 
 void Simulation::trans_sim(Matrix& mObj) {
-    // Ensure time axis is cleared
-    results.timeAxis.clear();
+    if (!ensemble_.empty()) {
+        trans_sim_ensemble(mObj);
+        return;
+    }
+    int64_t     start = 0;
     ProgressBar bar;
     if (!minOut_) {
         bar.create_thread();
@@ -85,52 +332,81 @@ void Simulation::trans_sim(Matrix& mObj) {
     }
     // Initialize the b matrix
     b_.resize(mObj.rp.size(), 0.0);
-    if (startup_) {
+    if (resume_) {
+        // Continue after the restored checkpoint
+        start = resume_.value() + 1;
+        resume_.reset();
+    } else {
+        // Ensure time axis is cleared
+        results.timeAxis.clear();
+    }
+    if (startup_ && start == 0) {
         // Stabilize the simulation before starting at t=0
-        int64_t startup = static_cast<int64_t>(2 * pow(10, (abs(log10(stepSize_)) - 12) * 2 + 1));
-        if (startup > 1000) { startup = 1000; }
+        int64_t startup = startup_steps();
         for (int64_t i = -startup; i < 0; ++i) {
-            double step = i * stepSize_;
-            // Setup the b matrix
-            setup_b(mObj, i, i * stepSize_);
+            // Assemble and solve the step
+            advance(mObj, i, i * stepSize_);
             if (needsTR_) { return; }
-            // Assign x_prev the new b
-            x_ = b_;
-            // Solve Ax=b, storing the results in x_
-#ifdef SLU
-            lu.solve(x_);
-#else
-            simOK_ = klu_l_tsolve(Symbolic_, Numeric_, mObj.rp.size() - 1, 1, &x_.front(), &Common_);
-            // If anything is a amiss, complain about it
-            if (!simOK_) { Errors::simulation_errors(SimulationErrors::MATRIX_SINGULAR); }
-#endif
         }
     }
-    // Start the simulation loop
-    for (int64_t i = 0; i < simSize_; ++i) {
-        double step = i * stepSize_;
+    // Start the simulation loop, i counts transient steps and advances by the current stride
+    for (int64_t i = start; i < simSize_; i += stride_) {
+        double step = i * baseStep_;
         // If not minimal printing report progress
         if (!minOut_) { bar.update(static_cast<float>(i)); }
-        // Setup the b matrix
-        setup_b(mObj, i, i * stepSize_);
-        if (needsTR_) { return; }
-        // Assign x_prev the new b
-        x_ = b_;
-        // Solve Ax=b, storing the results in x_
-#ifdef SLU
-        lu.solve(x_);
-#else
-        simOK_ = klu_l_tsolve(Symbolic_, Numeric_, mObj.rp.size() - 1, 1, &x_.front(), &Common_);
-        // If anything is a amiss, complain about it
-        if (!simOK_) { Errors::simulation_errors(SimulationErrors::MATRIX_SINGULAR); }
-#endif
-        // Store results (only requested, to prevent massive memory usage)
-        for (auto j = 0; j < results.xVector.size(); ++j) {
-            if (results.xVector.at(j)) { results.xVector.at(j).value().emplace_back(x_.at(j)); }
+        // Assemble and solve the step
+        advance(mObj, i, step);
+        if (needsTR_) {
+            // With adaptive steps first retry from the previous step with half the step size
+            int64_t previous = i - stride_;
+            if (lteTol_ > 0 && shrink_step(mObj, previous)) {
+                ++stats.rejectedSteps;
+                i = previous;
+                continue;
+            }
+            return;
+        }
+        if (lteTol_ > 0) {
+            // Reject the step if the junction phases are not accurate enough
+            double  lte      = junction_lte();
+            int64_t previous = i - stride_;
+            if (lte > lteTol_ && stride_ > 1 && shrink_step(mObj, previous)) {
+                ++stats.rejectedSteps;
+                i = previous;
+                continue;
+            }
+            // The error of BDF2 grows with the cube of the step, only grow with enough margin
+            quiet_ = (lte < lteTol_ / 8) ? quiet_ + 1 : 0;
+        }
+        ++stats.timeSteps;
+        store_tx(mObj, i);
+        if (monitor_) {
+            // The monitor decides when the transient is done
+            if (!monitor_(step, x_)) { break; }
+        } else if (decimator_.enabled()) {
+            decimator_.push(mObj, step, x_);
+        } else {
+            // Store results (only requested, to prevent massive memory usage)
+            for (auto j = 0; j < results.xVector.size(); ++j) {
+                if (results.xVector.at(j)) { results.xVector.at(j).value().emplace_back(x_.at(j)); }
+            }
+            // Store the time step
+            results.timeAxis.emplace_back(step);
+        }
+        // Keep the last few solutions and periodically checkpoint
+        if (checkpointInterval_ > 0 || lteTol_ > 0) { push_history(); }
+        if (checkpointInterval_ > 0 && i % checkpointInterval_ < stride_ && historyCount_ >= HISTORY_DEPTH) {
+            take_checkpoint(mObj, i);
+        }
+        // Choose the next step size
+        if (lteTol_ > 0) {
+            adapt_step(mObj, i);
+            if (needsTR_) { return; }
         }
-        // Store the time step
-        results.timeAxis.emplace_back(step);
     }
+    // Output expects results on the transient step grid
+    if (lteTol_ > 0 && !monitor_) { resample_results(); }
+    if (decimator_.enabled()) { decimator_.finish(results.printTimes, results.printTraces); }
     if (!minOut_) {
         bar.complete();
         std::cout << "\n";
@@ -139,23 +415,562 @@ void Simulation::trans_sim(Matrix& mObj) {
 
 void Simulation::reduce_step(Input& iObj, Matrix& mObj) {
     iObj.transSim.tstep(iObj.transSim.tstep() / 2);
-    Rng::rewind();
-    bool tempMinOut = iObj.argMin;
-    if (!iObj.argMin) { iObj.argMin = true; }
-    Matrix newmObj;
-    mObj = newmObj;
-    // Create the matrix in csr format
-    for (auto& i : mObj.sourcegen) { i.clearMisc(); }
-    mObj.create_matrix(iObj);
-    find_relevant_traces(iObj, mObj);
-    //// Dump expanded Netlist since it is no longer needed
-    // iObj.netlist.expNetlist.clear();
-    // iObj.netlist.expNetlist.shrink_to_fit();
-    if (!tempMinOut) { iObj.argMin = tempMinOut; }
+    ++stats.stepReductions;
+#ifndef SLU
+    // Cached factorizations were made for the previous step size
+    if (factorCache_.capacity() > 0) {
+        factorCache_.clear(&Common_);
+        Numeric_ = nullptr;
+    }
+#endif
+    // Continue from the last checkpoint if possible
+    if (checkpoint_ && restore_checkpoint(iObj, mObj)) {
+        ++stats.checkpointResumes;
+        return;
+    }
+    resume_.reset();
+    // Patch the step dependent entries in place, keeping the symbolic analysis
+    mObj.retime(iObj);
+    if (variants_ != nullptr) {
+        // Variants take their streams from the first instance again
+        Rng::Streams scratch;
+        auto*        outer = Rng::use(&scratch);
+        for (auto& v : *variants_) { v.retime(iObj); }
+        Rng::use(outer);
+    }
     results.xVector.clear();
     results.timeAxis.clear();
 }
 
+void Simulation::push_history() {
+    history_.at(historyCount_ % HISTORY_DEPTH) = x_;
+    ++historyCount_;
+}
+
+std::vector<std::vector<double>> Simulation::recent_history() const {
+    // Newest solution first
+    std::vector<std::vector<double>> window(std::min(historyCount_, HISTORY_DEPTH));
+    for (int64_t j = 0; j < window.size(); ++j) { window.at(j) = history_.at((historyCount_ - 1 - j) % HISTORY_DEPTH); }
+    return window;
+}
+
+int64_t Simulation::replay_steps(int64_t count, double windowStep, double step, int64_t last, int64_t stride) const {
+    if (count < 4) { return 0; }
+    // Limited by the span of the window and the start of the transient
+    int64_t replay
+            = std::min({REPLAY_STEPS, static_cast<int64_t>((count - 1) * windowStep / step), (last - 1) / stride});
+    // The oldest history used by any device is three steps back
+    return replay < 3 ? 0 : replay;
+}
+
+bool Simulation::rebuild_history(Matrix&                                 mObj,
+                                 const std::vector<std::vector<double>>& window,
+                                 double                                  windowStep,
+                                 int64_t                                 last) {
+    auto    count  = static_cast<int64_t>(window.size());
+    int64_t replay = replay_steps(count, windowStep, stepSize_, last, stride_);
+    if (replay == 0) { return false; }
+    std::vector<std::vector<double>> replayed;
+    for (int64_t r = replay; r > 0; --r) {
+        int64_t j = last - (r - 1) * stride_;
+        // Position of the solution one step before j among the window samples, oldest first
+        double  p = (count - 1) - r * stepSize_ / windowStep;
+        auto    s = Misc::stencil(count, p);
+        auto    w = Misc::lagrange_weights({static_cast<double>(s), s + 1.0, s + 2.0, s + 3.0}, p);
+        for (int64_t e = 0; e < x_.size(); ++e) {
+            x_.at(e) = 0.0;
+            for (int64_t k = 0; k < 4; ++k) { x_.at(e) += w.at(k) * window.at(count - 1 - (s + k)).at(e); }
+        }
+        replayed.emplace_back(x_);
+        setup_b(mObj, j, j * baseStep_);
+        if (needsTR_) { return false; }
+    }
+    // The solutions at the new step become the history
+    historyCount_ = 0;
+    for (auto& v : replayed) {
+        x_ = std::move(v);
+        push_history();
+    }
+    x_ = window.front();
+    push_history();
+    return true;
+}
+
+void Simulation::set_stride(Matrix& mObj, int64_t stride) {
+    double factor = static_cast<double>(stride) / static_cast<double>(stride_);
+    for (auto& i : mObj.components.devices) {
+        std::visit([&](auto& device) { device.update_timestep(factor); }, i);
+    }
+    stride_   = stride;
+    stepSize_ = stride_ * baseStep_;
+    jjBlock_.refresh();
+    // The past solutions of the plan are replaced when the history is rebuilt
+    if (stampPlan_.enabled()) { stampPlan_.load(mObj.components, atyp_, stepSize_, blockOf_); }
+    mObj.create_nz();
+    if (!cached_factorization(mObj)) { factorize(mObj); }
+}
+
+bool Simulation::shrink_step(Matrix& mObj, int64_t last) {
+    auto window = recent_history();
+    if (stride_ == 1 || replay_steps(window.size(), stepSize_, stepSize_ / 2, last, stride_ / 2) == 0) { return false; }
+    double windowStep = stepSize_;
+    needsTR_          = false;
+    needsLU_          = false;
+    quiet_            = 0;
+    set_stride(mObj, stride_ / 2);
+    return rebuild_history(mObj, window, windowStep, last);
+}
+
+void Simulation::adapt_step(Matrix& mObj, int64_t i) {
+    // Grow the step after a quiet stretch, provided the history spans the larger step
+    if (quiet_ >= REPLAY_STEPS && 2 * stride_ <= maxStride_ && i + 2 * stride_ <= simSize_ - 1) {
+        auto   window     = recent_history();
+        double windowStep = stepSize_;
+        if (replay_steps(window.size(), windowStep, 2 * stepSize_, i, 2 * stride_) == REPLAY_STEPS) {
+            quiet_ = 0;
+            set_stride(mObj, 2 * stride_);
+            if (!rebuild_history(mObj, window, windowStep, i)) {
+                // Junction phases move too fast for the larger step after all
+                needsTR_ = false;
+                set_stride(mObj, stride_ / 2);
+                rebuild_history(mObj, window, windowStep, i);
+            }
+        }
+    }
+    // Do not step past the end of the transient
+    while (!needsTR_ && stride_ > 1 && i < simSize_ - 1 && i + stride_ > simSize_ - 1) {
+        if (!shrink_step(mObj, i)) { break; }
+    }
+}
+
+double Simulation::junction_lte() const {
+    const auto& jj  = jjBlock_;
+    double      lte = 0.0;
+    for (int64_t j = 0; j < jj.size(); ++j) {
+        double phase = 0.0;
+        if (atyp_ == AnalysisType::Voltage) {
+            phase = x_.at(jj.variable.at(j));
+        } else {
+            if (jj.pos.at(j) >= 0) { phase += x_.at(jj.pos.at(j)); }
+            if (jj.neg.at(j) >= 0) { phase -= x_.at(jj.neg.at(j)); }
+        }
+        // Milne estimate from the difference to the quadratic predictor through the previous phases
+        double predictor = 3.0 * jj.p2.at(j) - 3.0 * jj.p3.at(j) + jj.p4.at(j);
+        lte              = std::max(lte, (2.0 / 11.0) * std::abs(phase - predictor));
+    }
+    return lte;
+}
+
+void Simulation::resample_results() {
+    auto& t = results.timeAxis;
+    auto  n = static_cast<int64_t>(t.size());
+    if (n < 4) { return; }
+    // Interpolation stencil and weights for every point of the transient step grid
+    std::vector<int64_t>               starts(simSize_);
+    std::vector<std::array<double, 4>> weights(simSize_);
+    int64_t                            s = 0;
+    for (int64_t k = 0; k < simSize_; ++k) {
+        double tk = k * baseStep_;
+        while (s + 1 < n && t.at(s + 1) <= tk) { ++s; }
+        starts.at(k)  = std::clamp(s - 1, static_cast<int64_t>(0), n - 4);
+        auto& st      = starts.at(k);
+        weights.at(k) = Misc::lagrange_weights({t.at(st), t.at(st + 1), t.at(st + 2), t.at(st + 3)}, tk);
+    }
+    for (auto& r : results.xVector) {
+        if (!r) { continue; }
+        auto&               v = r.value();
+        std::vector<double> nv(simSize_);
+        for (int64_t k = 0; k < simSize_; ++k) {
+            const auto& st = starts.at(k);
+            const auto& w  = weights.at(k);
+            nv.at(k) = w.at(0) * v.at(st) + w.at(1) * v.at(st + 1) + w.at(2) * v.at(st + 2) + w.at(3) * v.at(st + 3);
+        }
+        v = std::move(nv);
+    }
+    t.resize(simSize_);
+    for (int64_t k = 0; k < simSize_; ++k) { t.at(k) = k * baseStep_; }
+}
+
+void Simulation::setup_ensemble(Matrix& mObj, int64_t size) {
+    ensemble_.clear();
+    // Reserved so the packed state of an instance keeps pointing into its own components
+    ensemble_.reserve(size - 1);
+    for (int64_t k = 1; k < size; ++k) {
+        auto& inst = ensemble_.emplace_back();
+        if (variants_ != nullptr) {
+            // Variants draw the same noise as the first instance
+            const auto& variant = variants_->at(k - 1);
+            inst.components     = variant.components;
+            inst.sourcegen      = variant.sourcegen;
+            inst.rng            = Rng::derive(0);
+            inst.rng.noise      = Rng::noise();
+            inst.rng.spread     = Rng::spread();
+        } else {
+            inst.components = mObj.components;
+            inst.sourcegen  = mObj.sourcegen;
+            inst.rng        = Rng::derive(k);
+            // Noise functions drew their first sample when parsed, draw it again from the instance streams
+            auto* outer     = Rng::use(&inst.rng);
+            for (auto& f : inst.sourcegen) { f.redraw_noise(); }
+            for (const auto& j : inst.components.resistorIndices) {
+                auto& temp = std::get<Resistor>(inst.components.devices.at(j));
+                if (temp.thermalNoise) { temp.thermalNoise.value().redraw_noise(); }
+            }
+            for (const auto& j : inst.components.junctionIndices) {
+                auto& temp = std::get<JJ>(inst.components.devices.at(j));
+                if (temp.thermalNoise) { temp.thermalNoise.value().redraw_noise(); }
+            }
+            Rng::use(outer);
+        }
+        inst.x       = x_;
+        inst.results = results;
+        inst.results.timeAxis.clear();
+        inst.jjBlock.load(inst.components, atyp_);
+        inst.jjBlock.parallel(parallel_);
+        inst.stampPlan.parallel(parallel_);
+        if (stampPlan_.enabled()) { inst.stampPlan.load(inst.components, atyp_, stepSize_); }
+    }
+    signatures_.assign(size, junction_signature(mObj));
+    // The constructor factorizes this junction state right after setup
+    factorSignature_ = signatures_.front();
+}
+
+void Simulation::swap_instance(Matrix& mObj, int64_t k) {
+    // Exchange the state of instance k with the one in use, swapping again restores it
+    auto& inst = ensemble_.at(k - 1);
+    std::swap(mObj.components, inst.components);
+    std::swap(mObj.sourcegen, inst.sourcegen);
+    std::swap(x_, inst.x);
+    std::swap(jjBlock_, inst.jjBlock);
+    std::swap(stampPlan_, inst.stampPlan);
+    std::swap(results, inst.results);
+}
+
+bool Simulation::ensemble_step(Matrix& mObj, int64_t i, bool store) {
+    auto n    = static_cast<int64_t>(mObj.rp.size()) - 1;
+    auto size = ensemble_size();
+    block_.resize(n * size);
+    // Assemble every instance with its own history, sources and noise streams
+    Rng::Streams* outer = nullptr;
+    for (int64_t k = 0; k < size; ++k) {
+        if (k > 0) {
+            swap_instance(mObj, k);
+            outer = Rng::use(&ensemble_.at(k - 1).rng);
+        }
+        setup_b(mObj, i, i * stepSize_);
+        if (needsLU_) {
+            signatures_.at(k) = junction_signature(mObj);
+            needsLU_          = false;
+        }
+        std::copy(b_.begin(), b_.begin() + n, block_.begin() + k * n);
+        if (k > 0) {
+            Rng::use(outer);
+            swap_instance(mObj, k);
+        }
+        // A step too large for any instance is too large for the ensemble
+        if (needsTR_) { return false; }
+    }
+    // Instances in the same junction state share a factorization and are solved together
+    std::map<std::string, std::vector<int64_t>> groups;
+    for (int64_t k = 0; k < size; ++k) { groups[signatures_.at(k)].emplace_back(k); }
+    std::vector<double> grouped;
+    for (const auto& [signature, members] : groups) {
+        if (signature != factorSignature_) {
+            auto first = members.front();
+            if (first > 0) { swap_instance(mObj, first); }
+            if (!cached_factorization(mObj)) {
+                mObj.create_nz();
+                factorize(mObj);
+            }
+            if (first > 0) { swap_instance(mObj, first); }
+            factorSignature_ = signature;
+        }
+        if (groups.size() == 1) {
+            base_solve(mObj, block_.data(), size);
+            break;
+        }
+        grouped.resize(n * members.size());
+        for (int64_t g = 0; g < members.size(); ++g) {
+            std::copy_n(block_.begin() + members.at(g) * n, n, grouped.begin() + g * n);
+        }
+        base_solve(mObj, grouped.data(), members.size());
+        for (int64_t g = 0; g < members.size(); ++g) {
+            std::copy_n(grouped.begin() + g * n, n, block_.begin() + members.at(g) * n);
+        }
+    }
+    // Keep the solutions, and the results of transient steps
+    for (int64_t k = 0; k < size; ++k) {
+        if (k > 0) { swap_instance(mObj, k); }
+        x_.assign(block_.begin() + k * n, block_.begin() + (k + 1) * n);
+        if (store) {
+            store_tx(mObj, i);
+            for (auto j = 0; j < results.xVector.size(); ++j) {
+                if (results.xVector.at(j)) { results.xVector.at(j).value().emplace_back(x_.at(j)); }
+            }
+            results.timeAxis.emplace_back(i * stepSize_);
+        }
+        if (k > 0) { swap_instance(mObj, k); }
+    }
+    return true;
+}
+
+void Simulation::trans_sim_ensemble(Matrix& mObj) {
+    ProgressBar bar;
+    if (!minOut_) {
+        bar.create_thread();
+        bar.set_bar_width(30);
+        bar.fill_bar_progress_with("O");
+        bar.fill_bar_remainder_with(" ");
+        bar.set_status_text("Simulating ensemble");
+        bar.set_total((float) simSize_);
+    }
+    b_.resize(mObj.rp.size(), 0.0);
+    results.timeAxis.clear();
+    if (startup_) {
+        // Stabilize every instance before starting at t=0
+        for (int64_t i = -startup_steps(); i < 0; ++i) {
+            if (!ensemble_step(mObj, i, false)) { return; }
+        }
+    }
+    for (int64_t i = 0; i < simSize_; ++i) {
+        if (!minOut_) { bar.update(static_cast<float>(i)); }
+        if (!ensemble_step(mObj, i, true)) { return; }
+        ++stats.timeSteps;
+    }
+    if (!minOut_) {
+        bar.complete();
+        std::cout << "\n";
+    }
+}
+
+bool Simulation::has_noise(const Matrix& mObj) const {
+    for (const auto& f : mObj.sourcegen) {
+        if (f.is_noise()) { return true; }
+    }
+    for (const auto& j : mObj.components.resistorIndices) {
+        if (std::get<Resistor>(mObj.components.devices.at(j)).thermalNoise) { return true; }
+    }
+    for (const auto& j : mObj.components.junctionIndices) {
+        if (std::get<JJ>(mObj.components.devices.at(j)).thermalNoise) { return true; }
+    }
+    return false;
+}
+
+void Simulation::take_checkpoint(Matrix& mObj, int64_t i) {
+    if (!checkpoint_) { checkpoint_.emplace(); }
+    auto& cp      = checkpoint_.value();
+    cp.step       = i;
+    cp.baseStep   = baseStep_;
+    cp.stride     = stride_;
+    cp.results    = results.timeAxis.size();
+    cp.x          = recent_history();
+    jjBlock_.store();
+    cp.components = mObj.components;
+    cp.sourcegen  = mObj.sourcegen;
+    cp.noise      = Rng::noise();
+    cp.spread     = Rng::spread();
+}
+
+bool Simulation::restore_checkpoint(Input& iObj, Matrix& mObj) {
+    const auto& cp     = checkpoint_.value();
+    double      base   = iObj.transSim.tstep();
+    double      tc     = cp.step * cp.baseStep;
+    // Index of the checkpoint on the current and the new grid
+    int64_t     kept   = static_cast<int64_t>(std::llround(tc / baseStep_));
+    int64_t     resume = static_cast<int64_t>(std::llround(tc / base));
+    // Devices, sources and noise as they were at the checkpoint, rescaled to the new step
+    mObj.components    = cp.components;
+    mObj.sourcegen     = cp.sourcegen;
+    Rng::noise()       = cp.noise;
+    Rng::spread()      = cp.spread;
+    for (auto& i : mObj.components.devices) {
+        std::visit([&](auto& device) { device.update_timestep(base / cp.baseStep); }, i);
+    }
+    jjBlock_.load(mObj.components, atyp_, blockOf_);
+    mObj.create_nz();
+    double previous = baseStep_;
+    baseStep_       = base;
+    stride_         = cp.stride;
+    stepSize_       = stride_ * baseStep_;
+    simSize_        = iObj.transSim.simsize();
+    needsLU_        = false;
+    needsTR_        = false;
+    quiet_          = 0;
+    if (stampPlan_.enabled()) { stampPlan_.load(mObj.components, atyp_, stepSize_, blockOf_); }
+    factorize(mObj);
+    if (lteTol_ > 0) {
+        // Adaptive results are stored per step, drop those after the checkpoint
+        for (auto& r : results.xVector) {
+            if (r) { r.value().resize(cp.results); }
+        }
+        results.timeAxis.resize(cp.results);
+    } else {
+        // Resample the results up to the checkpoint onto the new grid
+        for (auto& r : results.xVector) {
+            if (!r) { continue; }
+            auto&               v = r.value();
+            std::vector<double> nv(resume + 1);
+            for (int64_t k = 0; k <= resume; ++k) {
+                double p = k * base / previous;
+                auto   s = Misc::stencil(kept + 1, p);
+                auto   w = Misc::lagrange_weights({static_cast<double>(s), s + 1.0, s + 2.0, s + 3.0}, p);
+                nv.at(k) = w.at(0) * v.at(s) + w.at(1) * v.at(s + 1) + w.at(2) * v.at(s + 2) + w.at(3) * v.at(s + 3);
+            }
+            v = std::move(nv);
+        }
+        results.timeAxis.resize(resume + 1);
+        for (int64_t k = 0; k <= resume; ++k) { results.timeAxis.at(k) = k * baseStep_; }
+    }
+    // Transmission lines keep the last steps before the checkpoint, interpolate them onto the new grid
+    for (const auto& j : mObj.components.txIndices) {
+        auto&   temp   = std::get<TransmissionLine>(mObj.components.devices.at(j));
+        auto    stored = std::move(temp.history_);
+        auto    depth  = static_cast<int64_t>(stored.size());
+        int64_t oldest = std::max(cp.step - depth + 1, static_cast<int64_t>(0));
+        temp.reset_history();
+        auto size = static_cast<int64_t>(temp.history_.size());
+        for (int64_t k = std::max(resume - size + 1, static_cast<int64_t>(0)); k <= resume; ++k) {
+            double p = k * base / cp.baseStep - oldest;
+            auto   s = Misc::stencil(cp.step - oldest + 1, p);
+            auto   w = Misc::lagrange_weights({static_cast<double>(s), s + 1.0, s + 2.0, s + 3.0}, p);
+            auto&  v = temp.history_.at(k % size);
+            for (int64_t l = 0; l < 4; ++l) {
+                const auto& o  = stored.at((oldest + s + l) % depth);
+                v.v1          += w.at(l) * o.v1;
+                v.v2          += w.at(l) * o.v2;
+                v.i1          += w.at(l) * o.i1;
+                v.i2          += w.at(l) * o.i2;
+            }
+        }
+    }
+    // Rebuild the device history at the new step by replaying the last few steps on interpolated solutions
+    if (!rebuild_history(mObj, cp.x, cp.stride * cp.baseStep, resume)) { return false; }
+    resume_ = resume;
+    return true;
+}
+
+void Simulation::factorize(Matrix& mObj) {
+#ifdef SLU
+    lu.factorize();
+#else
+    if (partitions_.enabled()) {
+        partitions_.factorize(mObj);
+        ++stats.factorizations;
+        return;
+    }
+    // Cached factorizations remain owned by the cache
+    if (Numeric_ != nullptr && factorCache_.capacity() == 0) { klu_l_free_numeric(&Numeric_, &Common_); }
+    size_t memusage = Common_.memusage;
+    Numeric_        = klu_l_factor(&mObj.rp.front(), &mObj.ci.front(), &mObj.nz.front(), Symbolic_, &Common_);
+    if (Numeric_ == nullptr) { Errors::simulation_errors(SimulationErrors::MATRIX_SINGULAR); }
+    // Store the pivot quality of this factorization as reference for later refactorizations
+    klu_l_rcond(Symbolic_, Numeric_, &Common_);
+    factorRcond_ = Common_.rcond;
+    if (factorCache_.capacity() > 0) {
+        factorCache_.insert(junction_signature(mObj), Numeric_, Common_.memusage - memusage, &Common_);
+    }
+#endif
+    if (lowRankMax_ > 0) { lowRank_.reset(mObj.nz, mObj.ci, mObj.rp); }
+    ++stats.factorizations;
+}
+
+void Simulation::refactorize(Matrix& mObj) {
+#ifdef SLU
+    // Refactor using the row permutation of the previous factorization
+    lu.factorize(true);
+    if (lu.is_stable()) {
+#else
+    // Blocks whose pivots degraded are factored again
+    if (partitions_.enabled()) {
+        if (partitions_.refactorize(mObj, PIVOT_TOLERANCE)) {
+            ++stats.refactorizations;
+        } else {
+            ++stats.factorizations;
+        }
+        return;
+    }
+    // Refactoring in place would overwrite a cached factorization
+    if (factorCache_.capacity() > 0) {
+        factorize(mObj);
+        return;
+    }
+    // Refactor using the pivot order of the previous factorization
+    if (klu_l_refactor(&mObj.rp.front(), &mObj.ci.front(), &mObj.nz.front(), Symbolic_, Numeric_, &Common_)
+        && klu_l_rcond(Symbolic_, Numeric_, &Common_) && Common_.rcond >= PIVOT_TOLERANCE * factorRcond_) {
+#endif
+        if (lowRankMax_ > 0) { lowRank_.reset(mObj.nz, mObj.ci, mObj.rp); }
+        ++stats.refactorizations;
+        return;
+    }
+    // Pivots degraded too much, do a full factorization
+    factorize(mObj);
+}
+
+bool Simulation::cached_factorization(Matrix& mObj) {
+#ifdef SLU
+    return false;
+#else
+    if (factorCache_.capacity() == 0) { return false; }
+    auto numeric = factorCache_.find(junction_signature(mObj));
+    if (numeric == nullptr) {
+        ++stats.cacheMisses;
+        return false;
+    }
+    // Swap in the factorization of this previously seen junction state
+    Numeric_ = numeric;
+    if (lowRankMax_ > 0) { lowRank_.reset(mObj.nz, mObj.ci, mObj.rp); }
+    ++stats.cacheHits;
+    return true;
+#endif
+}
+
+std::string Simulation::junction_signature(const Matrix& mObj) const {
+    // Adaptive steps change the matrix too, key on the stride as well
+    std::string signature = std::to_string(stride_) + ':';
+    signature.reserve(signature.size() + mObj.components.junctionIndices.size());
+    for (const auto& j : mObj.components.junctionIndices) {
+        signature.push_back(static_cast<char>('0' + std::get<JJ>(mObj.components.devices.at(j)).state()));
+    }
+    return signature;
+}
+
+void Simulation::base_solve(Matrix& mObj, std::vector<double>& x) {
+#ifdef SLU
+    lu.solve(x);
+#else
+    if (partitions_.enabled()) {
+        partitions_.solve(x);
+        return;
+    }
+    simOK_ = klu_l_tsolve(Symbolic_, Numeric_, mObj.rp.size() - 1, 1, &x.front(), &Common_);
+    // If anything is a amiss, complain about it
+    if (!simOK_) { Errors::simulation_errors(SimulationErrors::MATRIX_SINGULAR); }
+#endif
+}
+
+void Simulation::base_solve(Matrix& mObj, double* block, int64_t nrhs) {
+    auto n = static_cast<int64_t>(mObj.rp.size()) - 1;
+#ifdef SLU
+    std::vector<double> x(n);
+    for (int64_t k = 0; k < nrhs; ++k) {
+        std::copy(block + k * n, block + (k + 1) * n, x.begin());
+        lu.solve(x);
+        std::copy(x.begin(), x.end(), block + k * n);
+    }
+#else
+    // One traversal of the factors for all right hand sides
+    simOK_ = klu_l_tsolve(Symbolic_, Numeric_, n, nrhs, block, &Common_);
+    if (!simOK_) { Errors::simulation_errors(SimulationErrors::MATRIX_SINGULAR); }
+#endif
+}
+
+void Simulation::solve(Matrix& mObj) {
+    // Solve using the last factorization
+    base_solve(mObj, x_);
+    // Correct for any matrix entries that changed since
+    if (!lowRank_.empty()) { lowRank_.correct(x_); }
+}
+
 void Simulation::setup_b(Matrix& mObj, int64_t i, double step, double factor) {
     // Clear b matrix and reset
     b_.clear();
@@ -163,47 +978,203 @@ void Simulation::setup_b(Matrix& mObj, int64_t i, double step, double factor) {
     // Handle jj
     handle_jj(mObj, i, step, factor);
     if (needsTR_) { return; }
-    // Re-factorize the LU if any jj transitions
-    if (needsLU_) {
+    // Re-factorize the LU if any jj transitions, ensemble instances are factorized per junction state after assembly
+    if (needsLU_ && ensemble_.empty()) {
         mObj.create_nz();
-#ifdef SLU
-        lu.factorize(true);
-#else
-        klu_l_free_numeric(&Numeric_, &Common_);
-        Numeric_ = klu_l_factor(&mObj.rp.front(), &mObj.ci.front(), &mObj.nz.front(), Symbolic_, &Common_);
-#endif
+        // Reuse the factorization of a previously seen junction state if cached
+        if (!cached_factorization(mObj)) {
+            // Absorb the changed conductances as a low-rank correction if enabled and still small enough
+            if (lowRankMax_ > 0
+                && lowRank_.update(mObj.nz, lowRankMax_, [&](std::vector<double>& v) { base_solve(mObj, v); })) {
+                ++stats.lowRankUpdates;
+            } else {
+                refactorize(mObj);
+            }
+        }
         needsLU_ = false;
     }
-    // Handle current sources
-    handle_cs(mObj, step, i);
-    // Handle resistors
-    handle_resistors(mObj, step);
-    // Handle inductors
-    handle_inductors(mObj, factor);
-    // Handle capacitors
-    handle_capacitors(mObj);
-    // Handle voltage sources
-    handle_vs(mObj, i, step, factor);
+    if (stampPlan_.enabled()) {
+        // Current sources, resistors, inductors, capacitors, voltage sources, ccvs and vccs
+        stampPlan_.stamp(x_, b_, mObj.sourcegen, step);
+    } else {
+        // Handle current sources
+        handle_cs(mObj, step, i);
+        // Handle resistors
+        handle_resistors(mObj, step);
+        // Handle inductors
+        handle_inductors(mObj, factor);
+        // Handle capacitors
+        handle_capacitors(mObj);
+        // Handle voltage sources
+        handle_vs(mObj, i, step, factor);
+        // Handle ccvs
+        handle_ccvs(mObj);
+        // Handle vccs
+        handle_vccs(mObj);
+    }
     // Handle phase sources
-    handle_ps(mObj, i, step, factor);
-    // Handle ccvs
-    handle_ccvs(mObj);
-    // Handle vccs
-    handle_vccs(mObj);
+    handle_ps(mObj, mObj.components.psIndices, i, step, factor);
     // Handle transmission lines
     handle_tx(mObj, i, step);
 }
 
-void Simulation::handle_cs(Matrix& mObj, double& step, const int64_t& i) {
-    for (const auto& j : mObj.components.currentsources) {
-        if (j.indexInfo.nodeConfig_ == NodeConfig::POSGND) {
-            b_.at(j.indexInfo.posIndex_.value()) -= (mObj.sourcegen.at(j.sourceIndex_).value(step));
-        } else if (j.indexInfo.nodeConfig_ == NodeConfig::GNDNEG) {
-            b_.at(j.indexInfo.negIndex_.value()) += (mObj.sourcegen.at(j.sourceIndex_).value(step));
-        } else if (j.indexInfo.nodeConfig_ == NodeConfig::POSNEG) {
-            b_.at(j.indexInfo.posIndex_.value()) -= (mObj.sourcegen.at(j.sourceIndex_).value(step));
-            b_.at(j.indexInfo.negIndex_.value()) += (mObj.sourcegen.at(j.sourceIndex_).value(step));
+void Simulation::advance(Matrix& mObj, int64_t i, double step) {
+#ifndef SLU
+    if (!blockTasks_.empty()) {
+        advance_blocks(mObj, i, step);
+        return;
+    }
+#endif
+    // Setup the b matrix
+    setup_b(mObj, i, step);
+    if (needsTR_) { return; }
+    // Assign x_prev the new b
+    x_ = b_;
+    // Solve Ax=b, storing the results in x_
+    solve(mObj);
+}
+
+#ifndef SLU
+void Simulation::setup_blocks(const Matrix& mObj) {
+    blockTasks_.clear();
+    // The stamp plan keeps the rows of every block together unless a history term spans blocks
+    if (blockOf_.empty() || stampPlan_.blocks() != partitions_.size()) { return; }
+    // Phase sources are evaluated by the tasks, noise drawn there would depend on their order
+    for (const auto& j : mObj.components.psIndices) {
+        const auto& temp = std::get<PhaseSource>(mObj.components.devices.at(j));
+        if (mObj.sourcegen.at(temp.sourceIndex_).is_noise()) { return; }
+    }
+    // Consecutive blocks are joined into tasks of at least as many variables as are worth handing to a thread
+    std::vector<int64_t> taskOf(partitions_.size());
+    for (int64_t k = 0, rows = 0; k < partitions_.size(); ++k) {
+        if (blockTasks_.empty() || rows >= Parallel::MIN_CHUNK) {
+            blockTasks_.emplace_back();
+            blockTasks_.back().from = k;
+            rows                    = 0;
         }
+        blockTasks_.back().to  = k + 1;
+        rows                  += partitions_.rows(k).size();
+        taskOf.at(k)           = blockTasks_.size() - 1;
+    }
+    auto task = [&](int64_t variable) -> BlockTask& { return blockTasks_.at(taskOf.at(blockOf_.at(variable))); };
+    const auto& c      = mObj.components;
+    // The non zeros hold the node connections followed by those of every device, a junction's conductance last
+    int64_t     offset = 0;
+    for (const auto& it : mObj.nc) { offset += it.size(); }
+    std::unordered_map<const JJ*, int64_t> conductance;
+    for (const auto& i : c.devices) {
+        offset += std::visit([](const auto& device) { return device.matrixInfo.nonZeros_.size(); }, i);
+        if (const auto* jj = std::get_if<JJ>(&i)) { conductance.emplace(jj, offset - 1); }
+    }
+    for (int64_t j = 0; j < jjBlock_.size(); ++j) {
+        const auto& d = jjBlock_.device(j);
+        task(d.variableIndex_).junctions.emplace_back(j, conductance.at(&d));
+    }
+    for (const auto& j : c.psIndices) {
+        task(std::get<PhaseSource>(c.devices.at(j)).indexInfo.currentIndex_.value()).phaseSources.emplace_back(j);
+    }
+    // Either end of a line is stamped by the task of its current, the ends are only coupled through the delay
+    for (const auto& j : c.txIndices) {
+        const auto& temp   = std::get<TransmissionLine>(c.devices.at(j));
+        auto&       first  = task(temp.indexInfo.currentIndex_.value());
+        auto&       second = task(temp.currentIndex2_);
+        first.txTerminals.at(0).add(j, temp.indexInfo.posIndex_, temp.indexInfo.negIndex_);
+        first.txEnds.emplace_back(j, 0);
+        second.txTerminals.at(1).add(j, temp.posIndex2_, temp.negIndex2_);
+        second.txEnds.emplace_back(j, 1);
+    }
+}
+
+void Simulation::advance_blocks(Matrix& mObj, int64_t i, double step) {
+    bool              check = checkStep_ && (double) i / (double) simSize_ > 0.01;
+    // Per task 0 if solved, 1 if singular, 2 if refactored, 3 if factored again and 4 if the step is too large
+    std::vector<char> state(blockTasks_.size(), 0);
+    // Noise draws share one stream, so all sources and noise are evaluated first, in the order of a whole step
+    jjBlock_.draw_noise(step);
+    stampPlan_.begin_step(mObj.sourcegen, step);
+    // Every task assembles the rows of b of its blocks, refactors those in which a junction switched and solves them.
+    // The blocks only read their own variables of the previous solution.
+    Parallel::tasks(parallel_, blockTasks_.size(), [&](int64_t t) {
+        const auto& task     = blockTasks_.at(t);
+        bool        switched = false;
+        for (int64_t k = task.from; k < task.to; ++k) {
+            for (const auto& r : partitions_.rows(k)) { b_[r] = 0.0; }
+        }
+        if (!jjBlock_.stamp(x_, b_, i, step, stepSize_, check, switched, task.from, task.to)) {
+            state.at(t) = 4;
+            return;
+        }
+        if (switched) {
+            for (const auto& [j, entry] : task.junctions) { mObj.nz[entry] = jjBlock_.g[j]; }
+        }
+        stampPlan_.stamp_blocks(task.from, task.to, x_, b_);
+        handle_ps(mObj, task.phaseSources, i, step);
+        if (atyp_ == AnalysisType::Phase && i > 0) { gather_tx(mObj, task.txTerminals); }
+        for (const auto& [j, end] : task.txEnds) {
+            stamp_tx_end(std::get<TransmissionLine>(mObj.components.devices[j]), end, i);
+        }
+        for (int64_t k = task.from; k < task.to; ++k) {
+            char factored = switched ? partitions_.refactor(k, mObj, PIVOT_TOLERANCE) : 0;
+            if (factored == 1 || !partitions_.solve(k, b_, x_)) {
+                state.at(t) = 1;
+                return;
+            }
+            if (factored == 2) { state.at(t) = 3; }
+        }
+        if (switched && state.at(t) == 0) { state.at(t) = 2; }
+    });
+    if (std::count(state.begin(), state.end(), 4) > 0) {
+        needsTR_ = true;
+        return;
+    }
+    if (std::count(state.begin(), state.end(), 1) > 0) { Errors::simulation_errors(SimulationErrors::MATRIX_SINGULAR); }
+    if (std::count(state.begin(), state.end(), 3) > 0) {
+        ++stats.factorizations;
+    } else if (std::count(state.begin(), state.end(), 2) > 0) {
+        ++stats.refactorizations;
+    }
+}
+#endif
+
+void Simulation::TerminalGroups::add(int64_t device, const int_o& pos, const int_o& neg) {
+    Terminal t{device, pos.value_or(-1), neg.value_or(-1)};
+    if (pos && !neg) {
+        posGnd.emplace_back(t);
+    } else if (!pos && neg) {
+        gndNeg.emplace_back(t);
+    } else if (pos && neg) {
+        posNeg.emplace_back(t);
+    } else {
+        gndGnd.emplace_back(t);
+    }
+}
+
+void Simulation::group_terminals(const Matrix& mObj) {
+    // Every instance of an ensemble has the same devices, the groups hold for all of them
+    const auto& c = mObj.components;
+    csTerminals_  = TerminalGroups();
+    for (int64_t j = 0; j < c.currentsources.size(); ++j) {
+        const auto& info = c.currentsources.at(j).indexInfo;
+        csTerminals_.add(j, info.posIndex_, info.negIndex_);
+    }
+    txTerminals_.fill(TerminalGroups());
+    for (const auto& j : c.txIndices) {
+        const auto& temp = std::get<TransmissionLine>(c.devices.at(j));
+        txTerminals_.at(0).add(j, temp.indexInfo.posIndex_, temp.indexInfo.negIndex_);
+        txTerminals_.at(1).add(j, temp.posIndex2_, temp.negIndex2_);
+    }
+}
+
+void Simulation::handle_cs(Matrix& mObj, double& step, const int64_t& i) {
+    auto value = [&](const Terminal& t) {
+        return mObj.sourcegen[mObj.components.currentsources[t.device].sourceIndex_].value(step);
+    };
+    for (const auto& t : csTerminals_.posGnd) { b_[t.pos] -= value(t); }
+    for (const auto& t : csTerminals_.gndNeg) { b_[t.neg] += value(t); }
+    for (const auto& t : csTerminals_.posNeg) {
+        double v = value(t);
+        b_[t.pos] -= v;
+        b_[t.neg] += v;
     }
 }
 
@@ -260,137 +1231,44 @@ void Simulation::handle_inductors(Matrix& mObj, double factor) {
 }
 
 void Simulation::handle_capacitors(Matrix& mObj) {
-    for (const auto& j : mObj.components.capacitorIndices) {
-        auto& temp = std::get<Capacitor>(mObj.components.devices.at(j));
-        if (temp.indexInfo.posIndex_ && !temp.indexInfo.negIndex_) {
-            temp.pn1_ = (x_.at(temp.indexInfo.posIndex_.value()));
-        } else if (!temp.indexInfo.posIndex_ && temp.indexInfo.negIndex_) {
-            temp.pn1_ = (-x_.at(temp.indexInfo.negIndex_.value()));
-        } else if (temp.indexInfo.posIndex_ && temp.indexInfo.negIndex_) {
-            temp.pn1_ = (x_.at(temp.indexInfo.posIndex_.value()) - x_.at(temp.indexInfo.negIndex_.value()));
-        } else {
-            temp.pn1_ = 0.0;
-        }
-        if (atyp_ == AnalysisType::Voltage) {
-            // 4/3 Vp1 - 1/3 Vp2
-            b_.at(temp.indexInfo.currentIndex_.value()) = (4.0 / 3.0) * temp.pn1_ - (1.0 / 3.0) * temp.pn2_;
-        } else if (atyp_ == AnalysisType::Phase) {
-            // (8/3)φn-1 - (22/9)φn-2 + (8/9)φn-3 - (1/9)φn-4
-            b_.at(temp.indexInfo.currentIndex_.value()) = (8.0 / 3.0) * temp.pn1_ - (22.0 / 9.0) * temp.pn2_
-                                                          + (8.0 / 9.0) * temp.pn3_ - (1.0 / 9.0) * temp.pn4_;
-            temp.pn7_ = temp.pn6_;
-            temp.pn6_ = temp.pn5_;
-            temp.pn5_ = temp.pn4_;
-            temp.pn4_ = temp.pn3_;
-            temp.pn3_ = temp.pn2_;
-        }
-        temp.pn2_ = temp.pn1_;
-    }
-}
-
-void Simulation::handle_jj(Matrix& mObj, int64_t& i, double& step, double factor) {
-    for (const auto& j : mObj.components.junctionIndices) {
-        auto&       temp  = std::get<JJ>(mObj.components.devices.at(j));
-        const auto& model = temp.model_;
-        if (temp.indexInfo.posIndex_ && !temp.indexInfo.negIndex_) {
-            if (temp.thermalNoise) { b_.at(temp.indexInfo.posIndex_.value()) -= temp.thermalNoise.value().value(step); }
-            temp.pn1_ = (x_.at(temp.indexInfo.posIndex_.value()));
-        } else if (!temp.indexInfo.posIndex_ && temp.indexInfo.negIndex_) {
-            if (temp.thermalNoise) { b_.at(temp.indexInfo.negIndex_.value()) += temp.thermalNoise.value().value(step); }
-            temp.pn1_ = (-x_.at(temp.indexInfo.negIndex_.value()));
-        } else if (temp.indexInfo.posIndex_ && temp.indexInfo.negIndex_) {
-            if (temp.thermalNoise) {
-                b_.at(temp.indexInfo.posIndex_.value()) -= temp.thermalNoise.value().value(step);
-                b_.at(temp.indexInfo.negIndex_.value()) += temp.thermalNoise.value().value(step);
+    // Every capacitor only writes its own row, chunks of them are independent
+    const auto& capacitors = mObj.components.capacitorIndices;
+    Parallel::chunks(parallel_, capacitors.size(), [&](int64_t begin, int64_t end) {
+        for (int64_t l = begin; l < end; ++l) {
+            const auto& j    = capacitors[l];
+            auto&       temp = std::get<Capacitor>(mObj.components.devices.at(j));
+            if (temp.indexInfo.posIndex_ && !temp.indexInfo.negIndex_) {
+                temp.pn1_ = (x_.at(temp.indexInfo.posIndex_.value()));
+            } else if (!temp.indexInfo.posIndex_ && temp.indexInfo.negIndex_) {
+                temp.pn1_ = (-x_.at(temp.indexInfo.negIndex_.value()));
+            } else if (temp.indexInfo.posIndex_ && temp.indexInfo.negIndex_) {
+                temp.pn1_ = (x_.at(temp.indexInfo.posIndex_.value()) - x_.at(temp.indexInfo.negIndex_.value()));
+            } else {
+                temp.pn1_ = 0.0;
             }
-            temp.pn1_ = (x_.at(temp.indexInfo.posIndex_.value()) - x_.at(temp.indexInfo.negIndex_.value()));
-        } else {
-            temp.pn1_ = 0.0;
-        }
-        if (i > 0) {
             if (atyp_ == AnalysisType::Voltage) {
-                temp.vn1_ = temp.pn1_;
-                temp.pn1_ = x_.at(temp.variableIndex_);
+                // 4/3 Vp1 - 1/3 Vp2
+                b_.at(temp.indexInfo.currentIndex_.value()) = (4.0 / 3.0) * temp.pn1_ - (1.0 / 3.0) * temp.pn2_;
             } else if (atyp_ == AnalysisType::Phase) {
-                temp.vn1_ = x_.at(temp.variableIndex_);
-                temp.pn1_ = temp.pn1_;
-            }
-        }
-        // Guess voltage (V0)
-        double v0  = (5.0 / 2.0) * temp.vn1_ - 2.0 * temp.vn2_ + (1.0 / 2.0) * temp.vn3_;
-        // Phase guess (P0)
-        temp.phi0_ = (4.0 / 3.0) * temp.pn1_ - (1.0 / 3.0) * temp.pn2_
-                     + ((1.0 / Constants::SIGMA) * ((2.0 * (stepSize_)) / 3.0)) * v0;
-        // Ensure timestep is not too large
-        if ((double) i / (double) simSize_ > 0.01) {
-            if (abs(temp.phi0_ - temp.pn1_) > (0.20 * 2 * Constants::PI)) {
-                needsTR_ = true;
-                return;
-                /*Errors::simulation_errors(
-                  SimulationErrors::PHASEGUESS_TOO_LARGE, temp.netlistInfo.label_);*/
+                // (8/3)φn-1 - (22/9)φn-2 + (8/9)φn-3 - (1/9)φn-4
+                b_.at(temp.indexInfo.currentIndex_.value()) = (8.0 / 3.0) * temp.pn1_ - (22.0 / 9.0) * temp.pn2_
+                                                              + (8.0 / 9.0) * temp.pn3_ - (1.0 / 9.0) * temp.pn4_;
+                temp.pn7_ = temp.pn6_;
+                temp.pn6_ = temp.pn5_;
+                temp.pn5_ = temp.pn4_;
+                temp.pn4_ = temp.pn3_;
+                temp.pn3_ = temp.pn2_;
             }
+            temp.pn2_ = temp.pn1_;
         }
-        // (hbar / 2 * e) ( -(2 / h) φp1 + (1 / 2h) φp2 )
-        if (atyp_ == AnalysisType::Voltage) {
-            b_.at(temp.variableIndex_)
-                    = (Constants::SIGMA) * (-(2.0 / (stepSize_)) * temp.pn1_ + (1.0 / (2.0 * (stepSize_))) * temp.pn2_);
-            // (4 / 3) φp1 - (1/3) φp2
-        } else if (atyp_ == AnalysisType::Phase) {
-            b_.at(temp.variableIndex_) = (4.0 / 3.0) * temp.pn1_ - (1.0 / 3.0) * temp.pn2_;
-        }
-        temp.pn4_ = temp.pn3_;
-        temp.pn3_ = temp.pn2_;
-        temp.pn2_ = temp.pn1_;
-        temp.vn6_ = temp.vn5_;
-        temp.vn5_ = temp.vn4_;
-        temp.vn4_ = temp.vn3_;
-        temp.vn3_ = temp.vn2_;
-        // Update junction transition
-        if (model.rtype() == 1) {
-            auto testLU = temp.update_value(v0);
-            if (testLU && !needsLU_) { needsLU_ = true; }
-        }
-        // Ic * sin (phi * (φ0 - φ))
-        double ic_sin_phi = 0.0;
-        for (int harm = 0; harm < temp.model_.cpr().size(); ++harm) {
-            ic_sin_phi += temp.model_.ic()
-                          * (temp.model_.cpr().at(harm) * sin((harm + 1) * (temp.phi0_ - temp.model_.phiOff())));
-        }
-        if (!temp.model_.tDep()) {
-            // -(hR / h + 2RC) * (Ic sin (φ0) - 2C / h Vp1 + C/2h Vp2 + It)
-            b_.at(temp.indexInfo.currentIndex_.value())
-                    = (temp.matrixInfo.nonZeros_.back())
-                      * (ic_sin_phi - (((2 * model.c()) / (stepSize_)) * temp.vn1_)
-                         + ((model.c() / (2.0 * (stepSize_))) * temp.vn2_) + temp.it_);
-        } else {
-            double sin2_half_phi = 0.0;
-            for (int harm = 0; harm < temp.model_.cpr().size(); ++harm) {
-                sin2_half_phi += temp.model_.cpr().at(harm) * sin((harm + 1) * (temp.phi0_ - temp.model_.phiOff()) / 2);
-            }
-            sin2_half_phi  = sin2_half_phi * sin2_half_phi;
-            double sin_phi = 0.0;
-            for (int harm = 0; harm < temp.model_.cpr().size(); ++harm) {
-                sin_phi += temp.model_.cpr().at(harm) * sin((harm + 1) * (temp.phi0_ - temp.model_.phiOff()));
-            }
-            double sqrt_part = sqrt(1 - model.d() * sin2_half_phi);
-            b_.at(temp.indexInfo.currentIndex_.value()) =
-                    // -(hR / h + 2RC) *(
-                    (temp.matrixInfo.nonZeros_.back())
-                    * ((
-                               // (π * Δ / 2 * e * Rn)
-                               ((Constants::PI * temp.del_) / (2 * Constants::EV * temp.model_.rn()))
-                               // * (sin(φ0 - φ) / √(1 - D * sin²((φ0 - φ) / 2))
-                               * (sin_phi / sqrt_part)
-                               // * tanh(Δ / (2 * kB * T) * √(1 - D * sin²((φ0 - φ) / 2)))
-                               * tanh(temp.del_ / (2 * Constants::BOLTZMANN * model.t()) * sqrt_part))
-                       // - 2C / h Vp1
-                       - (((2 * model.c()) / stepSize_) * temp.vn1_)
-                       // + C/2h Vp2
-                       + ((model.c() / (2.0 * stepSize_)) * temp.vn2_)
-                       // + It)
-                       + temp.it_);
-        }
-        temp.vn2_ = temp.vn1_;
+    });
+}
+
+void Simulation::handle_jj(Matrix& mObj, int64_t& i, double& step, double factor) {
+    // Junction history is packed in jjBlock_, its devices are only updated when checkpointing
+    bool check = checkStep_ && (double) i / (double) simSize_ > 0.01;
+    if (!jjBlock_.stamp(x_, b_, i, step, stepSize_, check, needsLU_)) {
+        needsTR_ = true;
     }
 }
 
@@ -425,8 +1303,9 @@ void Simulation::handle_vs(Matrix& mObj, const int64_t& i, double& step, double
     }
 }
 
-void Simulation::handle_ps(Matrix& mObj, const int64_t& i, double& step, double factor) {
-    for (const auto& j : mObj.components.psIndices) {
+void Simulation::handle_ps(
+        Matrix& mObj, const std::vector<int64_t>& indices, const int64_t& i, double& step, double factor) {
+    for (const auto& j : indices) {
         auto& temp = std::get<PhaseSource>(mObj.components.devices.at(j));
         if (atyp_ == AnalysisType::Phase) {
             // φn
@@ -495,204 +1374,91 @@ void Simulation::handle_vccs(Matrix& mObj) {
 }
 
 void Simulation::handle_tx(Matrix& mObj, const int64_t& i, double& step, double factor) {
-    for (const auto& j : mObj.components.txIndices) {
-        auto&              temp = std::get<TransmissionLine>(mObj.components.devices.at(j));
-        // Z0
-        double&            Z    = temp.netlistInfo.value_;
-        // Td == k
-        int64_t&           k    = temp.timestepDelay_;
-        // Shorthands
-        JoSIM::NodeConfig &nc = temp.indexInfo.nodeConfig_, &nc2 = temp.nodeConfig2_;
-        int_o &posInd = temp.indexInfo.posIndex_, &negInd = temp.indexInfo.negIndex_, &posInd2 = temp.posIndex2_,
-              &negInd2  = temp.negIndex2_;
-        int64_t &curInd = temp.indexInfo.currentIndex_.value(), &curInd2 = temp.currentIndex2_;
-        if (atyp_ == AnalysisType::Voltage) {
-            if (i >= k) {
-                // φ1n-k
-                if (nc == NodeConfig::POSGND) {
-                    temp.nk_1_ = results.xVector.at(posInd.value()).value().at(i - k);
-                } else if (nc == NodeConfig::GNDNEG) {
-                    temp.nk_1_ = -results.xVector.at(negInd.value()).value().at(i - k);
-                } else if (nc == NodeConfig::POSNEG) {
-                    temp.nk_1_ = results.xVector.at(posInd.value()).value().at(i - k)
-                                 - results.xVector.at(negInd.value()).value().at(i - k);
-                } else {
-                    temp.nk_1_ = 0.0;
-                }
-                // φ2n-k
-                if (nc2 == NodeConfig::POSGND) {
-                    temp.nk_2_ = results.xVector.at(posInd2.value()).value().at(i - k);
-                } else if (nc2 == NodeConfig::GNDNEG) {
-                    temp.nk_2_ = -results.xVector.at(negInd2.value()).value().at(i - k);
-                } else if (nc2 == NodeConfig::POSNEG) {
-                    temp.nk_2_ = results.xVector.at(posInd2.value()).value().at(i - k)
-                                 - results.xVector.at(negInd2.value()).value().at(i - k);
-                } else {
-                    temp.nk_2_ = 0.0;
-                }
-                // I1n-k
-                double& I1nk   = results.xVector.at(curInd).value().at(i - k);
-                // I2n-k
-                double& I2nk   = results.xVector.at(curInd2).value().at(i - k);
-                // I1 = ZI2n-k + V2n-k
-                b_.at(curInd)  = Z * I2nk + temp.nk_2_;
-                // I2 = ZI1n-k + V1n-k
-                b_.at(curInd2) = Z * I1nk + temp.nk_1_;
-            }
-        } else if (atyp_ == AnalysisType::Phase) {
-            if (i > 0) {
-                temp.n2_1_ = temp.n1_1_;
-                temp.n2_2_ = temp.n1_2_;
-                // φ1n-1
-                if (nc == NodeConfig::POSGND) {
-                    temp.n1_1_ = (x_.at(posInd.value()));
-                } else if (nc == NodeConfig::GNDNEG) {
-                    temp.n1_1_ = (-x_.at(negInd.value()));
-                } else if (nc == NodeConfig::POSNEG) {
-                    temp.n1_1_ = (x_.at(posInd.value()) - x_.at(negInd.value()));
-                } else {
-                    temp.n1_1_ = 0.0;
-                }
-                // φ2n-1
-                if (nc2 == NodeConfig::POSGND) {
-                    temp.n1_2_ = (x_.at(posInd2.value()));
-                } else if (nc2 == NodeConfig::GNDNEG) {
-                    temp.n1_2_ = (-x_.at(negInd2.value()));
-                } else if (nc2 == NodeConfig::POSNEG) {
-                    temp.n1_2_ = (x_.at(posInd2.value()) - x_.at(negInd2.value()));
-                } else {
-                    temp.n1_2_ = 0.0;
-                }
-            }
-            if (i >= k) {
-                // φ1n-k
-                if (nc == NodeConfig::POSGND) {
-                    temp.nk_1_ = results.xVector.at(posInd.value()).value().at(i - k);
-                } else if (nc == NodeConfig::GNDNEG) {
-                    temp.nk_1_ = -results.xVector.at(negInd.value()).value().at(i - k);
-                } else if (nc == NodeConfig::POSNEG) {
-                    temp.nk_1_ = results.xVector.at(posInd.value()).value().at(i - k)
-                                 - results.xVector.at(negInd.value()).value().at(i - k);
-                } else {
-                    temp.nk_1_ = 0.0;
-                }
-                // φ2n-k
-                if (nc2 == NodeConfig::POSGND) {
-                    temp.nk_2_ = results.xVector.at(posInd2.value()).value().at(i - k);
-                } else if (nc2 == NodeConfig::GNDNEG) {
-                    temp.nk_2_ = -results.xVector.at(negInd2.value()).value().at(i - k);
-                } else if (nc2 == NodeConfig::POSNEG) {
-                    temp.nk_2_ = results.xVector.at(posInd2.value()).value().at(i - k)
-                                 - results.xVector.at(negInd2.value()).value().at(i - k);
-                } else {
-                    temp.nk_2_ = 0.0;
-                }
-                // I1n-k
-                double& I1nk = results.xVector.at(curInd).value().at(i - k);
-                // I2n-k
-                double& I2nk = results.xVector.at(curInd2).value().at(i - k);
-                if (i == k) {
-                    // I1 = Z(2e/hbar)(2h/3)I2n-k + (4/3)φ1n-1 - (1/3)φ1n-2 + φ2n-k
-                    b_.at(curInd) = (Z / Constants::SIGMA) * ((2.0 * stepSize_ * factor) / 3.0) * I2nk
-                                    + (4.0 / 3.0) * temp.n1_1_ - (1.0 / 3.0) * temp.n2_1_ + temp.nk_2_;
-                    // I2 = Z(2e/hbar)(2h/3)I1n-k + (4/3)φ2n-1 - (1/3)φ2n-2 + φ1n-k
-                    b_.at(curInd2) = (Z / Constants::SIGMA) * ((2.0 * stepSize_ * factor) / 3.0) * I1nk
-                                     + (4.0 / 3.0) * temp.n1_2_ - (1.0 / 3.0) * temp.n2_2_ + temp.nk_1_;
-                } else if (i == k + 1) {
-                    // φ1n-k-1
-                    if (nc == NodeConfig::POSGND) {
-                        temp.nk1_1_ = results.xVector.at(posInd.value()).value().at(i - k - 1);
-                    } else if (nc == NodeConfig::GNDNEG) {
-                        temp.nk1_1_ = -results.xVector.at(negInd.value()).value().at(i - k - 1);
-                    } else if (nc == NodeConfig::POSNEG) {
-                        temp.nk1_1_ = results.xVector.at(posInd.value()).value().at(i - k - 1)
-                                      - results.xVector.at(negInd.value()).value().at(i - k - 1);
-                    } else {
-                        temp.nk1_1_ = 0.0;
-                    }
-                    // φ2n-k-1
-                    if (nc2 == NodeConfig::POSGND) {
-                        temp.nk1_2_ = results.xVector.at(posInd2.value()).value().at(i - k - 1);
-                    } else if (nc2 == NodeConfig::GNDNEG) {
-                        temp.nk1_2_ = -results.xVector.at(negInd2.value()).value().at(i - k - 1);
-                    } else if (nc2 == NodeConfig::POSNEG) {
-                        temp.nk1_2_ = results.xVector.at(posInd2.value()).value().at(i - k - 1)
-                                      - results.xVector.at(negInd2.value()).value().at(i - k - 1);
-                    } else {
-                        temp.nk1_2_ = 0.0;
-                    }
-                    // I1 = Z(2e/hbar)(2h/3)I2n-k + (4/3)φ1n-1 - (1/3)φ1n-2 +
-                    //      φ2n-k - (4/3)φ2n-k-1
-                    b_.at(curInd) = (Z / Constants::SIGMA) * ((2.0 * stepSize_ * factor) / 3.0) * I2nk
-                                    + (4.0 / 3.0) * temp.n1_1_ - (1.0 / 3.0) * temp.n2_1_ + temp.nk_2_
-                                    - (4.0 / 3.0) * temp.nk1_2_;
-                    // I2 = Z(2e/hbar)(2h/3)I1n-k + (4/3)φ2n-1 - (1/3)φ2n-2 +
-                    //      φ1n-k - (4/3)φ1n-k-1
-                    b_.at(curInd2) = (Z / Constants::SIGMA) * ((2.0 * stepSize_ * factor) / 3.0) * I1nk
-                                     + (4.0 / 3.0) * temp.n1_2_ - (1.0 / 3.0) * temp.n2_2_ + temp.nk_1_
-                                     - (4.0 / 3.0) * temp.nk1_1_;
-                } else if (i > k + 1) {
-                    // φ1n-k-1
-                    if (nc == NodeConfig::POSGND) {
-                        temp.nk1_1_ = results.xVector.at(posInd.value()).value().at(i - k - 1);
-                    } else if (nc == NodeConfig::GNDNEG) {
-                        temp.nk1_1_ = -results.xVector.at(negInd.value()).value().at(i - k - 1);
-                    } else if (nc == NodeConfig::POSNEG) {
-                        temp.nk1_1_ = results.xVector.at(posInd.value()).value().at(i - k - 1)
-                                      - results.xVector.at(negInd.value()).value().at(i - k - 1);
-                    } else {
-                        temp.nk1_1_ = 0.0;
-                    }
-                    // φ2n-k-1
-                    if (nc2 == NodeConfig::POSGND) {
-                        temp.nk1_2_ = results.xVector.at(posInd2.value()).value().at(i - k - 1);
-                    } else if (nc2 == NodeConfig::GNDNEG) {
-                        temp.nk1_2_ = -results.xVector.at(negInd2.value()).value().at(i - k - 1);
-                    } else if (nc2 == NodeConfig::POSNEG) {
-                        temp.nk1_2_ = results.xVector.at(posInd2.value()).value().at(i - k - 1)
-                                      - results.xVector.at(negInd2.value()).value().at(i - k - 1);
-                    } else {
-                        temp.nk1_2_ = 0.0;
-                    }
-                    // φ1n-k-2
-                    if (nc == NodeConfig::POSGND) {
-                        temp.nk2_1_ = results.xVector.at(posInd.value()).value().at(i - k - 2);
-                    } else if (nc == NodeConfig::GNDNEG) {
-                        temp.nk2_1_ = -results.xVector.at(negInd.value()).value().at(i - k - 2);
-                    } else if (nc == NodeConfig::POSNEG) {
-                        temp.nk2_1_ = results.xVector.at(posInd.value()).value().at(i - k - 2)
-                                      - results.xVector.at(negInd.value()).value().at(i - k - 2);
-                    } else {
-                        temp.nk2_1_ = 0.0;
-                    }
-                    // φ2n-k-2
-                    if (nc2 == NodeConfig::POSGND) {
-                        temp.nk2_2_ = results.xVector.at(posInd2.value()).value().at(i - k - 2);
-                    } else if (nc2 == NodeConfig::GNDNEG) {
-                        temp.nk2_2_ = -results.xVector.at(negInd2.value()).value().at(i - k - 2);
-                    } else if (nc2 == NodeConfig::POSNEG) {
-                        temp.nk2_2_ = results.xVector.at(posInd2.value()).value().at(i - k - 2)
-                                      - results.xVector.at(negInd2.value()).value().at(i - k - 2);
-                    } else {
-                        temp.nk2_2_ = 0.0;
-                    }
-                    // I1 = Z(2e/hbar)(2h/3)I2n-k + (4/3)φ1n-1 - (1/3)φ1n-2 +
-                    //      φ2n-k - (4/3)φ2n-k-1 + (1/3)φ2n-k-2
-                    b_.at(curInd) = (Z / Constants::SIGMA) * ((2.0 * stepSize_ * factor) / 3.0) * I2nk
-                                    + (4.0 / 3.0) * temp.n1_1_ - (1.0 / 3.0) * temp.n2_1_ + temp.nk_2_
-                                    - (4.0 / 3.0) * temp.nk1_2_ + (1.0 / 3.0) * temp.nk2_2_;
-                    // I2 = Z(2e/hbar)(2h/3)I1n-k + (4/3)φ2n-1 - (1/3)φ2n-2 +
-                    //      φ1n-k - (4/3)φ1n-k-1 + (1/3)φ1n-k-2
-                    b_.at(curInd2) = (Z / Constants::SIGMA) * ((2.0 * stepSize_ * factor) / 3.0) * I1nk
-                                     + (4.0 / 3.0) * temp.n1_2_ - (1.0 / 3.0) * temp.n2_2_ + temp.nk_1_
-                                     - (4.0 / 3.0) * temp.nk1_1_ + (1.0 / 3.0) * temp.nk2_1_;
-                }
-            } else {
-                // I1 = (4/3)φ1n-1 - (1/3)φ1n-2
-                b_.at(curInd)  = (4.0 / 3.0) * temp.n1_1_ - (1.0 / 3.0) * temp.n2_1_;
-                // I2 = (4/3)φ2n-1 - (1/3)φ2n-2
-                b_.at(curInd2) = (4.0 / 3.0) * temp.n1_2_ - (1.0 / 3.0) * temp.n2_2_;
+    if (atyp_ == AnalysisType::Phase && i > 0) { gather_tx(mObj, txTerminals_); }
+    // Every line only writes its own rows, chunks of them are independent
+    const auto& lines = mObj.components.txIndices;
+    Parallel::chunks(parallel_, lines.size(), [&](int64_t begin, int64_t end) {
+        for (int64_t l = begin; l < end; ++l) {
+            auto& temp = std::get<TransmissionLine>(mObj.components.devices.at(lines[l]));
+            stamp_tx_end(temp, 0, i, factor);
+            stamp_tx_end(temp, 1, i, factor);
+        }
+    });
+}
+
+void Simulation::gather_tx(Matrix& mObj, const std::array<TerminalGroups, 2>& terminals) {
+    // φ1n-1 and φ2n-1 per node configuration of either end, keeping the previous ones as φn-2
+    auto& devices = mObj.components.devices;
+    auto  gather  = [&](const TerminalGroups& g, double TransmissionLine::*n1, double TransmissionLine::*n2) {
+        auto shift = [&](const Terminal& t, double value) {
+            auto& temp = std::get<TransmissionLine>(devices[t.device]);
+            temp.*n2   = temp.*n1;
+            temp.*n1   = value;
+        };
+        for (const auto& t : g.posGnd) { shift(t, x_[t.pos]); }
+        for (const auto& t : g.gndNeg) { shift(t, -x_[t.neg]); }
+        for (const auto& t : g.posNeg) { shift(t, x_[t.pos] - x_[t.neg]); }
+        for (const auto& t : g.gndGnd) { shift(t, 0.0); }
+    };
+    gather(terminals.at(0), &TransmissionLine::n1_1_, &TransmissionLine::n2_1_);
+    gather(terminals.at(1), &TransmissionLine::n1_2_, &TransmissionLine::n2_2_);
+}
+
+void Simulation::stamp_tx_end(TransmissionLine& temp, int64_t end, int64_t i, double factor) {
+    // Z0
+    double&  Z     = temp.netlistInfo.value_;
+    // Td == k
+    int64_t& k     = temp.timestepDelay_;
+    // The row of either end is driven by the delayed wave of the other end, I1 by end 2 and I2 by end 1
+    bool     first = end == 0;
+    int64_t  row   = first ? temp.indexInfo.currentIndex_.value() : temp.currentIndex2_;
+    double &nk = first ? temp.nk_2_ : temp.nk_1_, &nk1 = first ? temp.nk1_2_ : temp.nk1_1_,
+           &nk2 = first ? temp.nk2_2_ : temp.nk2_1_;
+    // φn-1 and φn-2 of this end
+    double n1 = first ? temp.n1_1_ : temp.n1_2_, n2 = first ? temp.n2_1_ : temp.n2_2_;
+    auto   v  = [&](int64_t j) { return first ? temp.delayed(j).v2 : temp.delayed(j).v1; };
+    if (atyp_ == AnalysisType::Voltage) {
+        if (i >= k) {
+            // φn-k of the other end
+            nk         = v(i - k);
+            // In-k of the other end
+            double Ink = first ? temp.delayed(i - k).i2 : temp.delayed(i - k).i1;
+            // I = ZIn-k + Vn-k
+            b_.at(row) = Z * Ink + nk;
+        }
+    } else if (atyp_ == AnalysisType::Phase) {
+        if (i >= k) {
+            // φn-k of the other end
+            nk         = v(i - k);
+            // In-k of the other end
+            double Ink = first ? temp.delayed(i - k).i2 : temp.delayed(i - k).i1;
+            if (i == k) {
+                // I = Z(2e/hbar)(2h/3)In-k + (4/3)φn-1 - (1/3)φn-2 + φn-k
+                b_.at(row) = (Z / Constants::SIGMA) * ((2.0 * stepSize_ * factor) / 3.0) * Ink + (4.0 / 3.0) * n1
+                             - (1.0 / 3.0) * n2 + nk;
+            } else if (i == k + 1) {
+                // φn-k-1 of the other end
+                nk1        = v(i - k - 1);
+                // I = Z(2e/hbar)(2h/3)In-k + (4/3)φn-1 - (1/3)φn-2 + φn-k - (4/3)φn-k-1
+                b_.at(row) = (Z / Constants::SIGMA) * ((2.0 * stepSize_ * factor) / 3.0) * Ink + (4.0 / 3.0) * n1
+                             - (1.0 / 3.0) * n2 + nk - (4.0 / 3.0) * nk1;
+            } else if (i > k + 1) {
+                // φn-k-1 and φn-k-2 of the other end
+                nk1        = v(i - k - 1);
+                nk2        = v(i - k - 2);
+                // I = Z(2e/hbar)(2h/3)In-k + (4/3)φn-1 - (1/3)φn-2 + φn-k - (4/3)φn-k-1 + (1/3)φn-k-2
+                b_.at(row) = (Z / Constants::SIGMA) * ((2.0 * stepSize_ * factor) / 3.0) * Ink + (4.0 / 3.0) * n1
+                             - (1.0 / 3.0) * n2 + nk - (4.0 / 3.0) * nk1 + (1.0 / 3.0) * nk2;
             }
+        } else {
+            // I = (4/3)φn-1 - (1/3)φn-2
+            b_.at(row) = (4.0 / 3.0) * n1 - (1.0 / 3.0) * n2;
         }
     }
 }
+
+void Simulation::store_tx(Matrix& mObj, int64_t i) {
+    for (const auto& j : mObj.components.txIndices) {
+        std::get<TransmissionLine>(mObj.components.devices.at(j)).store(i, x_);
+    }
+}
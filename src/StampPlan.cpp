@@ -0,0 +1,298 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/StampPlan.hpp"
+
+#include "JoSIM/Constants.hpp"
+#include "JoSIM/Parallel.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <unordered_map>
+
+using namespace JoSIM;
+
+namespace {
+// Entry of history matrix k, as (row, column, coefficient)
+struct Entry {
+    int64_t k;
+    int64_t row;
+    int64_t col;
+    double  coef;
+};
+
+// Add coef times the value across the positive and negative index to row of history matrix k
+void add_across(std::vector<Entry>& entries, int64_t k, int64_t row, const int_o& pos, const int_o& neg, double coef) {
+    if (pos) { entries.push_back({k, row, pos.value(), coef}); }
+    if (neg) { entries.push_back({k, row, neg.value(), -coef}); }
+}
+} // namespace
+
+int64_t StampPlan::add_source(int64_t sourceIndex) {
+    int64_t slot = values_.size();
+    values_.emplace_back(0.0);
+    sources_.emplace_back(slot, sourceIndex);
+    return slot;
+}
+
+int64_t StampPlan::add_noise(Function& noise) {
+    int64_t slot = values_.size();
+    values_.emplace_back(0.0);
+    noise_.emplace_back(slot, &noise);
+    return slot;
+}
+
+void StampPlan::clear() {
+    enabled_ = false;
+    values_.clear();
+    sources_.clear();
+    noise_.clear();
+    sourceTerms_.clear();
+    rows_.clear();
+    cols_.clear();
+    for (auto& h : history_) {
+        h.nz.clear();
+        h.ci.clear();
+        h.rp.clear();
+    }
+    for (auto& r : ring_) { r.clear(); }
+    head_ = 0;
+    for (auto* v : {&rowStart_, &colStart_, &termStart_}) { v->clear(); }
+}
+
+void StampPlan::load(Components& components, AnalysisType atyp, double h, const std::vector<int64_t>& blockOf) {
+    clear();
+    enabled_ = true;
+    // History matrix k multiplies the solution k + 1 steps back
+    std::vector<Entry> entries;
+    // Current sources
+    for (const auto& j : components.currentsources) {
+        int64_t s = add_source(j.sourceIndex_);
+        if (j.indexInfo.posIndex_) { sourceTerms_.push_back({j.indexInfo.posIndex_.value(), s, -1.0}); }
+        if (j.indexInfo.negIndex_) { sourceTerms_.push_back({j.indexInfo.negIndex_.value(), s, 1.0}); }
+    }
+    // Resistors, thermal noise and in phase mode 4/3 φp1 - 1/3 φp2
+    for (const auto& j : components.resistorIndices) {
+        auto& temp = std::get<Resistor>(components.devices.at(j));
+        auto& info = temp.indexInfo;
+        if (temp.thermalNoise) {
+            int64_t n = add_noise(temp.thermalNoise.value());
+            if (info.posIndex_) { sourceTerms_.push_back({info.posIndex_.value(), n, -1.0}); }
+            if (info.negIndex_) { sourceTerms_.push_back({info.negIndex_.value(), n, 1.0}); }
+        }
+        if (atyp == AnalysisType::Phase) {
+            int64_t row = info.currentIndex_.value();
+            add_across(entries, 0, row, info.posIndex_, info.negIndex_, 4.0 / 3.0);
+            add_across(entries, 1, row, info.posIndex_, info.negIndex_, -(1.0 / 3.0));
+        }
+    }
+    // Inductors, -2L/h Ip + L/2h Ip2 followed by -2M/h Im + M/2h Im2 for every mutual inductance
+    if (atyp == AnalysisType::Voltage) {
+        // Stamping order of every inductor, by device index
+        std::unordered_map<int64_t, int64_t> order;
+        for (const auto& j : components.inductorIndices) { order.emplace(j, static_cast<int64_t>(order.size())); }
+        for (const auto& j : components.inductorIndices) {
+            auto&   temp = std::get<Inductor>(components.devices.at(j));
+            int64_t row  = temp.indexInfo.currentIndex_.value();
+            double  L    = temp.netlistInfo.value_;
+            entries.push_back({0, row, row, -(2.0 * L / h)});
+            entries.push_back({1, row, row, L / (2.0 * h)});
+            for (const auto& m : temp.get_mutualInductance()) {
+                auto&   other = std::get<Inductor>(components.devices.at(m.first));
+                int64_t col   = other.indexInfo.currentIndex_.value();
+                // Inductors stamped earlier in the step have already advanced their history
+                int64_t past  = order.at(m.first) < order.at(j) ? 0 : 1;
+                entries.push_back({0, row, col, -((2 * m.second) / h)});
+                entries.push_back({past, row, col, m.second / (2.0 * h)});
+            }
+        }
+    }
+    // Capacitors
+    for (const auto& j : components.capacitorIndices) {
+        auto&   temp = std::get<Capacitor>(components.devices.at(j));
+        auto&   info = temp.indexInfo;
+        int64_t row  = info.currentIndex_.value();
+        if (atyp == AnalysisType::Voltage) {
+            // 4/3 Vp1 - 1/3 Vp2
+            add_across(entries, 0, row, info.posIndex_, info.negIndex_, 4.0 / 3.0);
+            add_across(entries, 1, row, info.posIndex_, info.negIndex_, -(1.0 / 3.0));
+        } else {
+            // (8/3)φn-1 - (22/9)φn-2 + (8/9)φn-3 - (1/9)φn-4
+            add_across(entries, 0, row, info.posIndex_, info.negIndex_, 8.0 / 3.0);
+            add_across(entries, 1, row, info.posIndex_, info.negIndex_, -(22.0 / 9.0));
+            add_across(entries, 2, row, info.posIndex_, info.negIndex_, 8.0 / 9.0);
+            add_across(entries, 3, row, info.posIndex_, info.negIndex_, -(1.0 / 9.0));
+        }
+    }
+    // Voltage sources
+    for (const auto& j : components.vsIndices) {
+        auto&   temp = std::get<VoltageSource>(components.devices.at(j));
+        auto&   info = temp.indexInfo;
+        int64_t row  = info.currentIndex_.value();
+        int64_t s    = add_source(temp.sourceIndex_);
+        if (atyp == AnalysisType::Voltage) {
+            // Vn
+            sourceTerms_.push_back({row, s, 1.0});
+        } else {
+            // (2e/hbar)(2h/3)Vn + (4/3)φn-1 - (1/3)φn-2
+            sourceTerms_.push_back({row, s, (2 * h) / (3 * Constants::SIGMA)});
+            add_across(entries, 0, row, info.posIndex_, info.negIndex_, 4.0 / 3.0);
+            add_across(entries, 1, row, info.posIndex_, info.negIndex_, -(1.0 / 3.0));
+        }
+    }
+    if (atyp == AnalysisType::Phase) {
+        // CCVS, 4/3 φp1 - 1/3 φp2
+        for (const auto& j : components.ccvsIndices) {
+            auto&   temp = std::get<CCVS>(components.devices.at(j));
+            auto&   info = temp.indexInfo;
+            int64_t row  = info.currentIndex_.value();
+            add_across(entries, 0, row, info.posIndex_, info.negIndex_, 4.0 / 3.0);
+            add_across(entries, 1, row, info.posIndex_, info.negIndex_, -(1.0 / 3.0));
+        }
+        // VCCS, 4/3 φp1 - 1/3 φp2 of the controlling nodes
+        for (const auto& j : components.vccsIndices) {
+            auto&   temp = std::get<VCCS>(components.devices.at(j));
+            int64_t row  = temp.indexInfo.currentIndex_.value();
+            add_across(entries, 0, row, temp.posIndex2_, temp.negIndex2_, 4.0 / 3.0);
+            add_across(entries, 1, row, temp.posIndex2_, temp.negIndex2_, -(1.0 / 3.0));
+        }
+    }
+    // Compress the rows and columns the history matrices use
+    for (const auto& e : entries) {
+        rows_.emplace_back(e.row);
+        cols_.emplace_back(e.col);
+    }
+    for (auto* v : {&rows_, &cols_}) {
+        std::sort(v->begin(), v->end());
+        v->erase(std::unique(v->begin(), v->end()), v->end());
+    }
+    auto position = [](const std::vector<int64_t>& v, int64_t value) {
+        return static_cast<int64_t>(std::lower_bound(v.begin(), v.end(), value) - v.begin());
+    };
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return std::tie(a.k, a.row, a.col) < std::tie(b.k, b.row, b.col);
+    });
+    // Build the CSR of every history matrix, summing entries of the same row and column
+    for (int64_t k = 0; k < DEPTH; ++k) { history_.at(k).rp.assign(rows_.size() + 1, 0); }
+    for (int64_t e = 0; e < entries.size(); ++e) {
+        const auto& en   = entries.at(e);
+        auto&       hk   = history_.at(en.k);
+        int64_t     col  = position(cols_, en.col);
+        bool        same = e > 0 && entries.at(e - 1).k == en.k && entries.at(e - 1).row == en.row
+                    && entries.at(e - 1).col == en.col;
+        if (same) {
+            hk.nz.back() += en.coef;
+        } else {
+            hk.nz.emplace_back(en.coef);
+            hk.ci.emplace_back(col);
+            ++hk.rp.at(position(rows_, en.row) + 1);
+        }
+    }
+    for (auto& hk : history_) {
+        for (int64_t r = 0; r < rows_.size(); ++r) { hk.rp.at(r + 1) += hk.rp.at(r); }
+    }
+    for (auto& r : ring_) { r.assign(cols_.size(), 0.0); }
+    if (!blockOf.empty()) { order_by_block(blockOf); }
+}
+
+void StampPlan::order_by_block(const std::vector<int64_t>& blockOf) {
+    int64_t blocks = *std::max_element(blockOf.begin(), blockOf.end()) + 1;
+    // A row only reads columns of its own block, blocks of the matrix share no entry
+    for (const auto& hk : history_) {
+        for (int64_t r = 0; r < rows_.size(); ++r) {
+            for (int64_t e = hk.rp.at(r); e < hk.rp.at(r + 1); ++e) {
+                if (blockOf.at(rows_.at(r)) != blockOf.at(cols_.at(hk.ci.at(e)))) { return; }
+            }
+        }
+    }
+    // Rows, columns and source terms of a block are kept together and in their order otherwise, so every row sums
+    // the same terms in the same order
+    auto order = [&](const std::vector<int64_t>& v, std::vector<int64_t>& start) {
+        std::vector<int64_t> p(v.size());
+        std::iota(p.begin(), p.end(), 0);
+        std::stable_sort(
+                p.begin(), p.end(), [&](int64_t a, int64_t b) { return blockOf.at(v.at(a)) < blockOf.at(v.at(b)); });
+        start.assign(blocks + 1, 0);
+        for (auto e : v) { ++start.at(blockOf.at(e) + 1); }
+        for (int64_t k = 0; k < blocks; ++k) { start.at(k + 1) += start.at(k); }
+        return p;
+    };
+    auto rowOrder = order(rows_, rowStart_);
+    auto colOrder = order(cols_, colStart_);
+    std::vector<int64_t> colPosition(cols_.size());
+    for (int64_t c = 0; c < colOrder.size(); ++c) { colPosition.at(colOrder.at(c)) = c; }
+    for (auto& hk : history_) {
+        HistoryMatrix ordered;
+        ordered.rp.emplace_back(0);
+        for (auto r : rowOrder) {
+            for (int64_t e = hk.rp.at(r); e < hk.rp.at(r + 1); ++e) {
+                ordered.nz.emplace_back(hk.nz.at(e));
+                ordered.ci.emplace_back(colPosition.at(hk.ci.at(e)));
+            }
+            ordered.rp.emplace_back(ordered.nz.size());
+        }
+        hk = std::move(ordered);
+    }
+    std::vector<int64_t> rows, cols;
+    for (auto r : rowOrder) { rows.emplace_back(rows_.at(r)); }
+    for (auto c : colOrder) { cols.emplace_back(cols_.at(c)); }
+    rows_ = std::move(rows);
+    cols_ = std::move(cols);
+    std::stable_sort(sourceTerms_.begin(), sourceTerms_.end(), [&](const SourceTerm& a, const SourceTerm& b) {
+        return blockOf.at(a.row) < blockOf.at(b.row);
+    });
+    termStart_.assign(blocks + 1, 0);
+    for (const auto& s : sourceTerms_) { ++termStart_.at(blockOf.at(s.row) + 1); }
+    for (int64_t k = 0; k < blocks; ++k) { termStart_.at(k + 1) += termStart_.at(k); }
+}
+
+void StampPlan::stamp(const std::vector<double>& x,
+                      std::vector<double>&       b,
+                      std::vector<Function>&     sourcegen,
+                      double                     t) {
+    // Sources and noise at the step time
+    for (const auto& [slot, s] : sources_) { values_[slot] = sourcegen[s].value(t); }
+    for (const auto& [slot, f] : noise_) { values_[slot] = f->value(t); }
+    for (const auto& s : sourceTerms_) { b[s.row] += s.coef * values_[s.slot]; }
+    // The last solution replaces the oldest in the ring
+    head_     = (head_ + DEPTH - 1) % DEPTH;
+    auto& now = ring_[head_];
+    Parallel::chunks(parallel_, cols_.size(), [&](int64_t begin, int64_t end) {
+        for (int64_t c = begin; c < end; ++c) { now[c] = x[cols_[c]]; }
+    });
+    // Row by row so chunks of rows are independent
+    Parallel::chunks(parallel_, rows_.size(), [&](int64_t begin, int64_t end) { add_history(begin, end, b); });
+}
+
+void StampPlan::add_history(int64_t begin, int64_t end, std::vector<double>& b) const {
+    // b += H1 x[n-1] + H2 x[n-2] + H3 x[n-3] + H4 x[n-4]
+    std::array<const double*, DEPTH> past;
+    for (int64_t k = 0; k < DEPTH; ++k) { past[k] = ring_[(head_ + k) % DEPTH].data(); }
+    for (int64_t r = begin; r < end; ++r) {
+        double sum = 0.0;
+        for (int64_t k = 0; k < DEPTH; ++k) {
+            const auto& hk = history_[k];
+            for (int64_t e = hk.rp[r]; e < hk.rp[r + 1]; ++e) { sum += hk.nz[e] * past[k][hk.ci[e]]; }
+        }
+        b[rows_[r]] += sum;
+    }
+}
+
+void StampPlan::begin_step(std::vector<Function>& sourcegen, double t) {
+    for (const auto& [slot, s] : sources_) { values_[slot] = sourcegen[s].value(t); }
+    for (const auto& [slot, f] : noise_) { values_[slot] = f->value(t); }
+    // The ring advances once for all blocks
+    head_ = (head_ + DEPTH - 1) % DEPTH;
+}
+
+void StampPlan::stamp_blocks(int64_t from, int64_t to, const std::vector<double>& x, std::vector<double>& b) {
+    // The stamps of consecutive blocks are stored consecutively
+    for (int64_t p = termStart_.at(from); p < termStart_.at(to); ++p) {
+        const auto& s = sourceTerms_[p];
+        b[s.row] += s.coef * values_[s.slot];
+    }
+    auto& now = ring_[head_];
+    for (int64_t c = colStart_.at(from); c < colStart_.at(to); ++c) { now[c] = x[cols_[c]]; }
+    add_history(rowStart_.at(from), rowStart_.at(to), b);
+}
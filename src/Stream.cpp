@@ -0,0 +1,97 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/Stream.hpp"
+
+#include "JoSIM/Errors.hpp"
+#include "JoSIM/FileOutputType.hpp"
+#include "JoSIM/Output.hpp"
+#include "JoSIM/Parameters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+using namespace JoSIM;
+
+Stream::Stream(const Input& iObj, const Matrix& mObj) {
+    auto so = iObj.find_option("STREAM");
+    if (!so || parse_param(so.value(), iObj.parameters) == 0) { return; }
+    // Output files with the index of the file their traces were requested for, the command line file takes all
+    std::vector<std::pair<OutputFile, int64_t>> outputs;
+    if (iObj.cli_output_file) { outputs.emplace_back(iObj.cli_output_file.value(), -1); }
+    for (int64_t i = 0; i < iObj.output_files.size(); ++i) { outputs.emplace_back(iObj.output_files.at(i), i); }
+    if (outputs.empty()) { return; }
+    auto traces = Output::labels(iObj, mObj);
+    names_.emplace_back("time");
+    for (const auto& i : traces) { names_.emplace_back(i.name_); }
+    for (const auto& [output, fIndex] : outputs) {
+        if (output.type() != FileOutputType::Csv && output.type() != FileOutputType::Dat) {
+            files_.clear();
+            return;
+        }
+        auto& f     = files_.emplace_back();
+        f.name      = output.name();
+        f.delimiter = output.type() == FileOutputType::Csv ? ',' : ' ';
+        for (int64_t k = 0; k < traces.size(); ++k) {
+            if (traces.at(k).fileIndex == fIndex || fIndex == -1) { f.columns.emplace_back(k + 1); }
+        }
+    }
+    width_ = static_cast<int64_t>(names_.size());
+    ring_.resize(CAPACITY * width_);
+    enabled_ = true;
+}
+
+void Stream::start() {
+    // Rows of a previous attempt are superseded
+    finish();
+    head_.store(0);
+    tail_.store(0);
+    closed_.store(false);
+    for (auto& f : files_) {
+        f.out.open(f.name, std::ios::trunc);
+        if (!f.out.is_open()) { Errors::output_errors(OutputErrors::CANNOT_OPEN_FILE, f.name); }
+        f.out << names_.front();
+        for (auto c : f.columns) { f.out << f.delimiter << names_.at(c); }
+        f.out << "\n" << std::scientific << std::setprecision(6);
+    }
+    writer_ = std::thread(&Stream::write, this);
+}
+
+void Stream::push(double t, const std::vector<double>& values) {
+    int64_t head = head_.load(std::memory_order_relaxed);
+    // Wait for the writer to free a row
+    while (head - tail_.load(std::memory_order_acquire) == CAPACITY) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    auto row = ring_.begin() + (head % CAPACITY) * width_;
+    *row     = t;
+    std::copy(values.begin(), values.end(), row + 1);
+    head_.store(head + 1, std::memory_order_release);
+}
+
+void Stream::write() {
+    int64_t tail = tail_.load(std::memory_order_relaxed);
+    while (true) {
+        if (tail == head_.load(std::memory_order_acquire)) {
+            // Rows pushed before closing are visible once it is seen
+            if (closed_.load(std::memory_order_acquire) && tail == head_.load(std::memory_order_acquire)) { break; }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+        const double* row = ring_.data() + (tail % CAPACITY) * width_;
+        for (auto& f : files_) {
+            f.out << row[0];
+            for (auto c : f.columns) { f.out << f.delimiter << row[c]; }
+            f.out << "\n";
+        }
+        tail_.store(++tail, std::memory_order_release);
+    }
+}
+
+void Stream::finish() {
+    if (!writer_.joinable()) { return; }
+    closed_.store(true, std::memory_order_release);
+    writer_.join();
+    for (auto& f : files_) { f.out.close(); }
+}
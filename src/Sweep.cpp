@@ -0,0 +1,190 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/Sweep.hpp"
+
+#include "JoSIM/Batch.hpp"
+#include "JoSIM/Errors.hpp"
+#include "JoSIM/Matrix.hpp"
+#include "JoSIM/Misc.hpp"
+#include "JoSIM/Parameters.hpp"
+#include "JoSIM/RelevantTrace.hpp"
+#include "JoSIM/Rng.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace JoSIM;
+
+Sweep::Sweep(const Input& iObj) {
+    for (const auto& c : iObj.controls) {
+        if (c.empty() || c.front() != "SWEEP") { continue; }
+        // .sweep NAME LIST V1 [V2 ...] or .sweep NAME START STOP STEP
+        if (c.size() < 4 || (c.at(2) != "LIST" && c.size() != 5)) {
+            Errors::control_errors(ControlErrors::INVALID_SWEEP, Misc::vector_to_string(c));
+        }
+        Axis axis{ParameterName(c.at(1), std::nullopt), {}};
+        if (iObj.parameters.count(axis.name) == 0) {
+            Errors::control_errors(ControlErrors::ANALYSIS_PARAM_NOT_FOUND, c.at(1));
+        }
+        if (c.at(2) == "LIST") {
+            axis.values.assign(c.begin() + 3, c.end());
+        } else {
+            double start = parse_param(c.at(2), iObj.parameters);
+            double stop  = parse_param(c.at(3), iObj.parameters);
+            double step  = parse_param(c.at(4), iObj.parameters);
+            if (step == 0.0 || (stop - start) / step < 0.0) {
+                Errors::control_errors(ControlErrors::INVALID_SWEEP, Misc::vector_to_string(c));
+            }
+            // Values are written as expressions of the given tokens, avoiding rounding in a printed value
+            auto count = static_cast<int64_t>(std::floor((stop - start) / step + 1E-9)) + 1;
+            for (int64_t k = 0; k < count; ++k) {
+                axis.values.emplace_back("(" + c.at(2) + ")+" + std::to_string(k) + "*(" + c.at(4) + ")");
+            }
+        }
+        axes_.emplace_back(axis);
+    }
+    if (!axes_.empty()) {
+        points_ = 1;
+        for (const auto& a : axes_) { points_ *= a.values.size(); }
+    }
+    threads_ = Batch::threads(iObj, points_);
+#ifndef SLU
+    if (auto ls = iObj.find_option("LOCKSTEP")) {
+        lockstep_ = std::max(static_cast<int64_t>(parse_param(ls.value(), iObj.parameters)), static_cast<int64_t>(1));
+    }
+    // Ensembles step the whole transient with a fixed step
+    for (const auto* o : {"ADAPTIVE", "CHECKPOINT", "PARAREAL", "PSS"}) {
+        auto v = iObj.find_option(o);
+        if (v && parse_param(v.value(), iObj.parameters) != 0) { lockstep_ = 1; }
+    }
+#endif
+}
+
+std::vector<std::pair<ParameterName, std::string>> Sweep::point(int64_t k) const {
+    std::vector<std::pair<ParameterName, std::string>> expressions;
+    // The last axis varies fastest
+    for (auto a = axes_.size(); a-- > 0;) {
+        const auto& values = axes_.at(a).values;
+        expressions.emplace_back(axes_.at(a).name, values.at(k % values.size()));
+        k /= values.size();
+    }
+    return expressions;
+}
+
+void Sweep::run_point(const Input& iObj, int64_t k) {
+    Input pointInp = iObj;
+    Batch::assign(pointInp, point(k));
+    for (const auto& a : axes_) { values_.at(k).emplace_back(pointInp.parameters.at(a.name).get_value().value()); }
+    // Every point draws the same spread and noise
+    outputs_.at(k) = Batch::simulate(pointInp, 0, k == 0, symbolic_.get());
+}
+
+void Sweep::run_batch(const Input& iObj, int64_t first, int64_t last) {
+    // Every point is set up like Batch::simulate, from its own copy of the input and the streams of a plain run
+    int64_t                   count = last - first;
+    std::vector<Input>        inputs(count, iObj);
+    std::vector<Matrix>       matrices(count);
+    std::vector<Rng::Streams> streams(count);
+    for (int64_t j = 0; j < count; ++j) {
+        auto& pointInp = inputs.at(j);
+        Batch::assign(pointInp, point(first + j));
+        for (const auto& a : axes_) {
+            values_.at(first + j).emplace_back(pointInp.parameters.at(a.name).get_value().value());
+        }
+        pointInp.argMin      = true;
+        pointInp.argVerb     = 0;
+        pointInp.argParallel = false;
+        streams.at(j)        = Rng::derive(0);
+        auto* outer          = Rng::use(&streams.at(j));
+        matrices.at(j).create_matrix(pointInp);
+        Rng::use(outer);
+        if (first + j == 0) { pointInp.netlist.sanity_check(matrices.at(j).components); }
+        find_relevant_traces(pointInp, matrices.at(j));
+    }
+    // The points with the nonzeros of the first point left are its variants
+    std::vector<bool> done(count, false);
+    for (int64_t j = 0; j < count; ++j) {
+        if (done.at(j)) { continue; }
+        const auto&          base = matrices.at(j);
+        std::vector<int64_t> members;
+        std::vector<Matrix>  variants;
+        for (int64_t m = j + 1; m < count && members.size() + 1 < lockstep_; ++m) {
+            const auto& other = matrices.at(m);
+            if (!done.at(m) && other.nz == base.nz && other.ci == base.ci && other.rp == base.rp) {
+                members.emplace_back(m);
+                variants.emplace_back(std::move(matrices.at(m)));
+                done.at(m) = true;
+            }
+        }
+        auto*      outer = Rng::use(&streams.at(j));
+        Simulation sObj(
+                inputs.at(j), matrices.at(j), symbolic_.get(), nullptr, nullptr, variants.empty() ? nullptr : &variants);
+        Rng::use(outer);
+        outputs_.at(first + j).write_output(inputs.at(j), matrices.at(j), sObj);
+        // Instances are written with the step the transient ended with
+        for (int64_t g = 0; g < members.size(); ++g) {
+            outputs_.at(first + members.at(g)).write_output(inputs.at(j), variants.at(g), sObj.instance_results(g + 1));
+        }
+    }
+}
+
+void Sweep::run(const Input& iObj) {
+    outputs_.assign(points_, Output());
+    values_.assign(points_, std::vector<double>());
+    // Symbolic analysis of the first point, values do not change the sparsity pattern
+    Input  patternInp = iObj;
+    Batch::assign(patternInp, point(0));
+    Matrix pattern;
+    pattern.create_matrix(patternInp);
+    symbolic_ = std::make_unique<SharedSymbolic>(pattern);
+    if (lockstep_ > 1) {
+        // One batch of consecutive points per thread
+        int64_t size    = (points_ + threads_ - 1) / threads_;
+        int64_t batches = (points_ + size - 1) / size;
+        Batch::run(
+                batches,
+                threads_,
+                [&](int64_t b) { run_batch(iObj, b * size, std::min((b + 1) * size, points_)); },
+                "Simulating sweep points",
+                iObj.argMin);
+    } else {
+        Batch::run(points_, threads_, [&](int64_t k) { run_point(iObj, k); }, "Simulating sweep points", iObj.argMin);
+    }
+    symbolic_.reset();
+}
+
+void Sweep::write_sweep(const Input& iObj) const {
+    // Time, sweep index and swept values followed by the traces, concatenated over the points
+    Output sweep;
+    sweep.traces.emplace_back("time");
+    sweep.traces.back().type_ = 'T';
+    sweep.traces.emplace_back("sweep");
+    sweep.traces.back().type_ = 'S';
+    for (const auto& a : axes_) {
+        sweep.traces.emplace_back(a.name.name());
+        sweep.traces.back().type_ = 'S';
+    }
+    const auto& first = outputs_.front().traces;
+    for (int64_t i = 1; i < first.size(); ++i) {
+        sweep.traces.emplace_back(first.at(i).name_);
+        sweep.traces.back().type_     = first.at(i).type_;
+        sweep.traces.back().fileIndex = first.at(i).fileIndex;
+    }
+    int64_t swept = 2 + axes_.size();
+    for (int64_t k = 0; k < points_; ++k) {
+        const auto& traces = outputs_.at(k).traces;
+        auto        rows   = traces.front().data_.size();
+        auto&       time   = sweep.traces.at(0).data_;
+        time.insert(time.end(), traces.front().data_.begin(), traces.front().data_.end());
+        sweep.traces.at(1).data_.insert(sweep.traces.at(1).data_.end(), rows, static_cast<double>(k));
+        for (int64_t a = 0; a < axes_.size(); ++a) {
+            sweep.traces.at(2 + a).data_.insert(sweep.traces.at(2 + a).data_.end(), rows, values_.at(k).at(a));
+        }
+        for (int64_t i = 1; i < traces.size(); ++i) {
+            auto& data = sweep.traces.at(swept + i - 1).data_;
+            data.insert(data.end(), traces.at(i).data_.begin(), traces.at(i).data_.end());
+        }
+    }
+    sweep.format_output(iObj);
+}
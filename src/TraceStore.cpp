@@ -0,0 +1,160 @@
+// Copyright (c) 2025 Johannes Delport
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "JoSIM/TraceStore.hpp"
+
+#include "JoSIM/Errors.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+using namespace JoSIM;
+
+namespace {
+// Little endian bytes of an unsigned integer
+template <typename T> void put(std::vector<char>& bytes, int64_t at, T value) {
+    for (int64_t k = 0; k < sizeof(T); ++k) { bytes.at(at + k) = static_cast<char>(value >> (8 * k)); }
+}
+
+template <typename T> T get(const char* bytes) {
+    T value = 0;
+    for (int64_t k = 0; k < sizeof(T); ++k) { value |= static_cast<T>(static_cast<unsigned char>(bytes[k])) << (8 * k); }
+    return value;
+}
+
+uint64_t align(uint64_t offset, uint64_t alignment) { return (offset + alignment - 1) / alignment * alignment; }
+} // namespace
+
+void TraceStore::write(const std::string& filename, const std::vector<std::string>& names, const std::vector<char>& types,
+                       const std::vector<const std::vector<double>*>& columns) {
+    uint64_t points = columns.empty() ? 0 : columns.front()->size();
+    uint64_t count  = columns.size();
+    // Header, index and names, padded up to the first column
+    uint64_t nameOffset = HEADER_SIZE + ENTRY_SIZE * count, nameSize = 0;
+    for (const auto& i : names) { nameSize += i.size(); }
+    uint64_t          dataOffset = align(nameOffset + nameSize, DATA_ALIGN);
+    uint64_t          stride     = align(8 * points, COLUMN_ALIGN);
+    std::vector<char> head(dataOffset, 0);
+    std::memcpy(head.data(), MAGIC, sizeof(MAGIC));
+    put<uint32_t>(head, 8, FORMAT_VERSION);
+    put<uint32_t>(head, 12, 0);
+    put<uint64_t>(head, 16, count);
+    put<uint64_t>(head, 24, points);
+    put<uint64_t>(head, 32, HEADER_SIZE);
+    put<uint64_t>(head, 40, nameOffset);
+    put<uint64_t>(head, 48, dataOffset);
+    put<uint64_t>(head, 56, dataOffset + stride * count);
+    uint64_t name = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        int64_t entry = HEADER_SIZE + ENTRY_SIZE * i;
+        put<uint64_t>(head, entry, name);
+        put<uint32_t>(head, entry + 8, names.at(i).size());
+        head.at(entry + 12) = types.at(i);
+        put<uint64_t>(head, entry + 16, dataOffset + stride * i);
+        put<uint64_t>(head, entry + 24, points);
+        std::memcpy(head.data() + nameOffset + name, names.at(i).data(), names.at(i).size());
+        name += names.at(i).size();
+    }
+    std::ofstream outfile(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outfile.is_open()) { Errors::output_errors(OutputErrors::CANNOT_OPEN_FILE, filename); }
+    outfile.write(head.data(), head.size());
+    // Columns are padded with zeros up to the next cache line
+    std::vector<char> column(stride, 0);
+    for (const auto* c : columns) {
+        for (uint64_t j = 0; j < points; ++j) {
+            uint64_t bits;
+            std::memcpy(&bits, &c->at(j), sizeof(bits));
+            put<uint64_t>(column, 8 * j, bits);
+        }
+        outfile.write(column.data(), column.size());
+    }
+    outfile.close();
+}
+
+TraceStore::TraceStore(const std::string& filename) {
+#ifdef _WIN32
+    file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                        nullptr);
+    LARGE_INTEGER size;
+    if (file_ == INVALID_HANDLE_VALUE) { file_ = nullptr; }
+    if (!file_ || !GetFileSizeEx(file_, &size)) {
+        close();
+        Errors::output_errors(OutputErrors::CANNOT_READ_STORE, filename);
+    }
+    size_ = static_cast<uint64_t>(size.QuadPart);
+    if (size_ >= HEADER_SIZE) {
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_) { map_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)); }
+    }
+#else
+    file_ = ::open(filename.c_str(), O_RDONLY);
+    struct stat info;
+    if (file_ < 0 || ::fstat(file_, &info) != 0) {
+        close();
+        Errors::output_errors(OutputErrors::CANNOT_READ_STORE, filename);
+    }
+    size_ = static_cast<uint64_t>(info.st_size);
+    if (size_ >= HEADER_SIZE) {
+        void* map = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, file_, 0);
+        if (map != MAP_FAILED) { map_ = static_cast<const char*>(map); }
+    }
+#endif
+    // The header and index are checked against the file size so that no column reaches past its end
+    bool valid = map_ && std::memcmp(map_, MAGIC, sizeof(MAGIC)) == 0 && get<uint32_t>(map_ + 8) == FORMAT_VERSION;
+    if (valid) {
+        uint64_t count = get<uint64_t>(map_ + 16), indexOffset = get<uint64_t>(map_ + 32),
+                 nameOffset = get<uint64_t>(map_ + 40);
+        points_         = get<uint64_t>(map_ + 24);
+        valid           = indexOffset <= size_ && count <= (size_ - indexOffset) / ENTRY_SIZE && nameOffset <= size_;
+        for (uint64_t i = 0; valid && i < count; ++i) {
+            const char* entry = map_ + indexOffset + ENTRY_SIZE * i;
+            uint64_t    name = get<uint64_t>(entry), nameSize = get<uint32_t>(entry + 8);
+            auto&       e = index_.emplace_back();
+            e.type        = entry[12];
+            e.offset      = get<uint64_t>(entry + 16);
+            e.length      = get<uint64_t>(entry + 24);
+            valid         = name <= size_ - nameOffset && nameSize <= size_ - nameOffset - name && e.offset <= size_ &&
+                    e.offset % sizeof(double) == 0 && e.length <= (size_ - e.offset) / sizeof(double);
+            if (valid) { e.name.assign(map_ + nameOffset + name, nameSize); }
+        }
+    }
+    if (!valid) {
+        close();
+        Errors::output_errors(OutputErrors::INVALID_STORE, filename);
+    }
+}
+
+std::optional<int64_t> TraceStore::find(const std::string& name) const {
+    for (int64_t i = 0; i < index_.size(); ++i) {
+        if (index_.at(i).name == name) { return i; }
+    }
+    return std::nullopt;
+}
+
+void TraceStore::close() {
+#ifdef _WIN32
+    if (map_) { UnmapViewOfFile(map_); }
+    if (mapping_) { CloseHandle(mapping_); }
+    if (file_) { CloseHandle(file_); }
+    mapping_ = nullptr;
+    file_    = nullptr;
+#else
+    if (map_) { ::munmap(const_cast<char*>(map_), size_); }
+    if (file_ >= 0) { ::close(file_); }
+    file_ = -1;
+#endif
+    map_ = nullptr;
+    index_.clear();
+}
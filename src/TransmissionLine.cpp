@@ -61,6 +61,7 @@ TransmissionLine::TransmissionLine(const std::pair<tokens_t, string_o>& s,
                                    const double&                        h,
                                    int64_t&                             bi) {
     at_ = at;
+    h_  = h;
     // Check if the label has already been defined
     if (lm.count(s.first.at(0)) != 0) {
         Errors::invalid_component_errors(ComponentErrors::DUPLICATE_LABEL, s.first.at(0));
@@ -89,7 +90,8 @@ TransmissionLine::TransmissionLine(const std::pair<tokens_t, string_o>& s,
                 Errors::invalid_component_errors(ComponentErrors::INVALID_TX_DEFINED, Misc::vector_to_string(s.first));
             }
             // Set the time delay (TD), this should be a value
-            timestepDelay_ = static_cast<int64_t>(std::round(parse_param(s.first.at(i).substr(3), pm, s.second) / h));
+            td_            = parse_param(s.first.at(i).substr(3), pm, s.second);
+            timestepDelay_ = static_cast<int64_t>(std::round(td_ / h));
         }
     }
     // Set the node configuration type
@@ -125,6 +127,7 @@ TransmissionLine::TransmissionLine(const std::pair<tokens_t, string_o>& s,
         // If phase mdoe analysis then append -(2*h/3) * (Z0/σ)
         matrixInfo.nonZeros_.emplace_back(-(2.0 * h / 3.0) * (netlistInfo.value_ / Constants::SIGMA));
     }
+    reset_history();
 }
 
 void TransmissionLine::set_secondary_node_indices(const tokens_t& t, const nodemap& nm, nodeconnections& nc) {
@@ -180,8 +183,35 @@ void TransmissionLine::set_secondary_matrix_info() {
     matrixInfo.columnIndex_.emplace_back(currentIndex2_);
 }
 
+namespace {
+// Value across a port of the solution x
+double port_value(const NodeConfig& nc, const int_o& pos, const int_o& neg, const std::vector<double>& x) {
+    switch (nc) {
+        case NodeConfig::POSGND: return x.at(pos.value());
+        case NodeConfig::GNDNEG: return -x.at(neg.value());
+        case NodeConfig::POSNEG: return x.at(pos.value()) - x.at(neg.value());
+        default: return 0.0;
+    }
+}
+} // namespace
+
+void TransmissionLine::reset_history() {
+    history_.assign(timestepDelay_ + 4, Sample());
+}
+
+void TransmissionLine::store(int64_t i, const std::vector<double>& x) {
+    auto& s = history_.at(i % history_.size());
+    s.v1    = port_value(indexInfo.nodeConfig_, indexInfo.posIndex_, indexInfo.negIndex_, x);
+    s.v2    = port_value(nodeConfig2_, posIndex2_, negIndex2_, x);
+    s.i1    = x.at(indexInfo.currentIndex_.value());
+    s.i2    = x.at(currentIndex2_);
+}
+
 // Update timestep based on a scalar factor i.e 0.5 for half the timestep
 void TransmissionLine::update_timestep(const double& factor) {
+    // The delay is a whole number of steps
+    h_             = factor * h_;
+    timestepDelay_ = static_cast<int64_t>(std::round(td_ / h_));
     if (at_ == AnalysisType::Phase) {
         matrixInfo.nonZeros_.at(hDepPos_) = factor * matrixInfo.nonZeros_.at(hDepPos_);
         matrixInfo.nonZeros_.back()       = factor * matrixInfo.nonZeros_.back();
@@ -118,3 +118,41 @@ void Verbose::print_expanded_netlist(const Input& iObj) {
     for (const auto& i : iObj.netlist.expNetlist) { std::cout << Misc::vector_to_string(i.first) << std::endl; }
     std::cout << std::endl;
 }
+
+void Verbose::print_solver_stats(const int64_t& vl, const Simulation& sObj) {
+    print_solver_stats(vl, sObj.stats);
+}
+
+void Verbose::print_solver_stats(const int64_t& vl, const SolverStats& stats) {
+    if (vl < 1) { return; }
+    std::cout << "Printing solver statistics:" << std::endl;
+    // Print the number of full factorizations
+    std::cout << std::left << std::setw(26) << "Factorizations:" << stats.factorizations << "\n";
+    // Print the number of refactorizations that reused the pivot order
+    std::cout << std::left << std::setw(26) << "Refactorizations:" << stats.refactorizations << "\n";
+    // Print the number of changes handled as low-rank corrections
+    std::cout << std::left << std::setw(26) << "Low-rank updates:" << stats.lowRankUpdates << "\n";
+    // Print the factorization cache performance
+    std::cout << std::left << std::setw(26) << "Factor cache hits:" << stats.cacheHits << "\n";
+    std::cout << std::left << std::setw(26) << "Factor cache misses:" << stats.cacheMisses << "\n";
+    // Print the number of times the step size was halved
+    std::cout << std::left << std::setw(26) << "Step reductions:" << stats.stepReductions << "\n";
+    std::cout << std::left << std::setw(26) << "Checkpoint resumes:" << stats.checkpointResumes << "\n";
+    // Print the number of accepted and rejected time steps
+    std::cout << std::left << std::setw(26) << "Time steps:" << stats.timeSteps << "\n";
+    std::cout << std::left << std::setw(26) << "Rejected steps:" << stats.rejectedSteps << "\n";
+    // Print the Parareal iterations and estimated speedup
+    if (stats.pararealIterations > 0) {
+        std::cout << std::left << std::setw(26) << "Parareal iterations:" << stats.pararealIterations << "\n";
+        std::cout << std::left << std::setw(26) << "Parareal speedup:" << stats.pararealSpeedup << "\n";
+    }
+    // Print the periods simulated to find the periodic steady state
+    if (stats.pssIterations > 0) {
+        std::cout << std::left << std::setw(26) << "PSS iterations:" << stats.pssIterations << "\n";
+    }
+    // Print the number of blocks of a partitioned matrix
+    if (stats.partitions > 0) {
+        std::cout << std::left << std::setw(26) << "Matrix partitions:" << stats.partitions << "\n";
+    }
+    std::cout << std::endl;
+}
@@ -6,12 +6,17 @@
 #include "JoSIM/Errors.hpp"
 #include "JoSIM/IV.hpp"
 #include "JoSIM/Input.hpp"
+#include "JoSIM/Islands.hpp"
+#include "JoSIM/Margin.hpp"
 #include "JoSIM/Matrix.hpp"
 #include "JoSIM/Model.hpp"
+#include "JoSIM/MonteCarlo.hpp"
 #include "JoSIM/Noise.hpp"
 #include "JoSIM/Output.hpp"
 #include "JoSIM/Parameters.hpp"
 #include "JoSIM/Simulation.hpp"
+#include "JoSIM/Stream.hpp"
+#include "JoSIM/Sweep.hpp"
 #include "JoSIM/Transient.hpp"
 #include "JoSIM/Verbose.hpp"
 
@@ -41,6 +46,27 @@ int main(int argc, const char** argv) {
         IV ivObj(iObj);
         // Identify the simulation parameters
         Transient::identify_simulation(iObj.controls, iObj.transSim, iObj.parameters);
+        // Run the Monte Carlo samples instead of a single simulation if requested
+        MonteCarlo mcObj(iObj);
+        if (mcObj.enabled()) {
+            mcObj.run(iObj);
+            mcObj.write_summary(iObj);
+            return 0;
+        }
+        // Bisect the margins of the requested parameters
+        Margin mgObj(iObj);
+        if (mgObj.enabled()) {
+            mgObj.run(iObj);
+            mgObj.write_margins(iObj);
+            return 0;
+        }
+        // Simulate every point of the requested parameter sweeps
+        Sweep swObj(iObj);
+        if (swObj.enabled()) {
+            swObj.run(iObj);
+            swObj.write_sweep(iObj);
+            return 0;
+        }
         // Create matrix object
         Matrix mObj;
         // Create the matrix in csr format
@@ -51,10 +77,28 @@ int main(int argc, const char** argv) {
         Verbose::handle_verbosity(iObj.argVerb, iObj, mObj);
         //  Find the relevant traces to store
         find_relevant_traces(iObj, mObj);
+        // Simulate the disconnected islands of the circuit independently
+        Islands isObj(iObj, mObj);
+        if (isObj.enabled()) {
+            auto results = isObj.run(iObj, mObj);
+            Verbose::print_solver_stats(iObj.argVerb, isObj.stats());
+            Output oObj(iObj, mObj, results);
+            return 0;
+        }
+        // Write the output files while simulating if requested
+        Stream     stObj(iObj, mObj);
         // Create a simulation object
-        Simulation sObj(iObj, mObj);
+        Simulation sObj(iObj, mObj, nullptr, nullptr, &stObj);
+        // Report solver statistics if verbose
+        Verbose::print_solver_stats(iObj.argVerb, sObj);
+        if (stObj.started()) {
+            stObj.finish();
+            return 0;
+        }
         // Create an output object
         Output     oObj(iObj, mObj, sObj);
+        // Every further ensemble instance writes its own output
+        for (int64_t k = 1; k < sObj.ensemble_size(); ++k) { Output eObj(iObj, mObj, sObj, k); }
         // Finish
         return 0;
     } catch (std::runtime_error& formattedMessage) {